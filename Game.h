@@ -1,1833 +1,5579 @@
-#include <iostream>
-#pragma once
-
-#include <SFML/Graphics.hpp>
-#include <SFML/Audio.hpp>
-#include <vector>
-#include <string>
-#include <iostream>
-#include <fstream>
-#include <cmath>
-#include <cstdlib>
-#include <ctime>
-#include <optional>
-
-#define M_PI 3.14159265358979323846
-
-// ============================================================================
-// GAME STATE ENUM
-// ============================================================================
-enum class GameState {
-    MENU,
-    PLAYING,
-    GAME_OVER,
-    HIGHSCORE,
-	LOADING,
-	OPTIONS 
-};
-
-// ============================================================================
-// BULLET
-// ============================================================================
-struct Bullet {
-	// Bullet sprite and direction
-    sf::Sprite sprite;
-    sf::Vector2f direction;
-    float speed = 500.f;
-	// Constructor
-    Bullet(const sf::Texture& texture, float x, float y, float dirX, float dirY)
-        : sprite(texture), direction(dirX, dirY)
-    {
-        sprite.setPosition({ x, y });
-        sprite.setScale({ 1.5f, 1.5f });
-        float angleDeg = std::atan2(dirY, dirX) * 180.f / 3.14159f;
-        sprite.setRotation(sf::degrees(angleDeg + 90.f));
-    }
-	// Get bullet bounds and position
-    sf::FloatRect getGlobalBounds() const { return sprite.getGlobalBounds(); }
-    const sf::Vector2f& getPosition() const { return sprite.getPosition(); }
-	// Update bullet position
-    void update(sf::Time dt) {
-        sprite.move(direction * speed * dt.asSeconds());
-    }
-	// Render bullet
-    void render(sf::RenderWindow& target) {
-        target.draw(sprite);
-    }
-};
-
-// ============================================================================
-// EXPLOSION
-// ============================================================================
-struct Explosion {
-	// Explosion frames and sprite
-    const std::vector<sf::Texture>* frames;
-    sf::Sprite sprite;
-    int currentFrame = 0;
-    float frameTimer = 0.f;
-    float frameDuration = 0.05f;
-    bool finished = false;
-	// Constructor
-    Explosion(const std::vector<sf::Texture>* explosionFrames, float x, float y)
-        : frames(explosionFrames), sprite((*explosionFrames)[0])
-    {
-        if (!frames->empty()) {
-            sf::FloatRect bounds = sprite.getLocalBounds();
-            sprite.setOrigin({ bounds.size.x / 2.0f, bounds.size.y / 1.5f });
-            sprite.setPosition({ x, y });
-            sprite.setScale({ 2.f, 2.f });
-        }
-    }
-	// Update explosion animation
-    void update(sf::Time dt) {
-        if (finished || frames->empty()) return;
-        frameTimer += dt.asSeconds();
-        if (frameTimer >= frameDuration) {
-            frameTimer = 0.f;
-            currentFrame++;
-            if (currentFrame >= static_cast<int>(frames->size())) {
-                finished = true;
-            } else {
-                sprite.setTexture((*frames)[currentFrame], true);
-            }
-        }
-    }
-	// Render explosion
-    void render(sf::RenderWindow& target) {
-        if (!finished) target.draw(sprite);
-    }
-	// Check if explosion animation is finished
-    bool isFinished() const { return finished; }
-};
-
-// ============================================================================
-// POWERUP
-// ============================================================================
-struct Powerup {
-	// Powerup types
-    enum Type { SCORE_BONUS = 0, HEAL = 1, TRIPLE_SHOT = 2 };
-	// Powerup sprite and type
-    sf::Sprite sprite;
-    Type type;
-    float speed = 100.f;
-	// Constructor
-    Powerup(const sf::Texture& texture, Type t, float x, float y)
-        : sprite(texture), type(t)
-    {
-        sprite.setPosition({ x, y });
-        sprite.setScale({ 0.04f, 0.04f });
-        sf::FloatRect bounds = sprite.getLocalBounds();
-        sprite.setOrigin({ bounds.size.x / 2.f, bounds.size.y / 2.f });
-    }
-	// Update powerup position
-    void update(sf::Time dt) {
-        sprite.move({ 0.f, speed * dt.asSeconds() });
-    }
-	// Render powerup
-    void render(sf::RenderWindow& target) { target.draw(sprite); }
-    sf::FloatRect getGlobalBounds() const { return sprite.getGlobalBounds(); }
-    Type getType() const { return type; }
-};
-
-// ============================================================================
-// ASTEROID
-// ============================================================================
-struct Asteroid {
-    sf::Sprite sprite;
-	// Asteroid attributes
-    float speed = 20.f;
-    float rotationSpeed = 45.f;
-    int health = 15;
-    bool isAlive = true;
-	// Constructor
-    Asteroid(const sf::Texture& texture, float startX, float startY)
-        : sprite(texture)
-    {
-        sprite.setPosition({ startX, startY });
-        sprite.setScale({ 0.8f, 0.8f });
-        sf::FloatRect bounds = sprite.getLocalBounds();
-        sprite.setOrigin({ bounds.size.x / 2.f, bounds.size.y / 2.f });
-    }
-	// Get asteroid bounds and position
-    sf::FloatRect getGlobalBounds() const { return sprite.getGlobalBounds(); }
-    const sf::Vector2f& getPosition() const { return sprite.getPosition(); }
-	// Damage asteroid
-    void takeDamage(int damage) {
-        health -= damage;
-        if (health <= 0) isAlive = false;
-    }
-	// Update asteroid position and rotation
-    void update(sf::Time dt) {
-        if (!isAlive) return;
-        float newY = sprite.getPosition().y + (speed * dt.asSeconds());
-        sprite.setPosition({ sprite.getPosition().x, newY });
-        sprite.rotate(sf::degrees(rotationSpeed * dt.asSeconds()));
-    }
-	// Render asteroid
-    void render(sf::RenderWindow& target) {
-        if (isAlive) target.draw(sprite);
-    }
-};
-
-// ============================================================================
-// ENEMY
-// ============================================================================
-struct Enemy {
-	// Enemy sprite
-    sf::Sprite sprite;
-	// Enemy attributes
-    float speed = 50.f;
-    int hp = 70;
-    float startX;
-    float sineTimer = 0.f;
-    float shootCooldown;
-    float shootTimer = 0.f;
-	// Constructor
-    Enemy(const sf::Texture& texture, float x, float y)
-        : sprite(texture), startX(x)
-    {
-        shootCooldown = static_cast<float>(rand() % 40 + 20) / 10.f;
-        sprite.setPosition({ x, y });
-        sprite.setScale({ 0.11f, 0.11f });
-        sf::FloatRect bounds = sprite.getLocalBounds();
-        sprite.setOrigin({ bounds.size.x / 2.f, bounds.size.y / 2.f });
-    }
-	// Get enemy bounds and position
-    sf::FloatRect getGlobalBounds() const { return sprite.getGlobalBounds(); }
-    const sf::Vector2f& getPosition() const { return sprite.getPosition(); }
-    int getHp() const { return hp; }
-	// damage enemy
-    void takeDamage(int damage) {
-        hp -= damage;
-        if (hp < 0) hp = 0;
-    }
-	// Update enemy state
-    void update(sf::Time dt, std::vector<Bullet>& bullets, const sf::Texture& bulletTex) {
-        sineTimer += dt.asSeconds();
-        float newY = sprite.getPosition().y + (speed * dt.asSeconds());
-        float newX = startX + (std::sin(sineTimer * 0.5f) * 100.f);
-        float spriteWidth = sprite.getGlobalBounds().size.x;
-        newX = std::max(spriteWidth / 2.f, std::min(newX, 1200.f - spriteWidth / 2.f));
-        sprite.setPosition({ newX, newY });
-
-        shootTimer += dt.asSeconds();
-        if (shootTimer >= shootCooldown) {
-            shootTimer = 0.f;
-            bullets.emplace_back(bulletTex, sprite.getPosition().x, sprite.getPosition().y, 0.f, 1.f);
-        }
-    }
-	// Render enemy
-    void render(sf::RenderWindow& target) { target.draw(sprite); }
-};
-
-// ============================================================================
-// BOSS
-// ============================================================================
-struct Boss {
-    sf::Sprite sprite;
-    sf::RectangleShape hpBarOuter, hpBarInner;
-	// Boss attributes
-    int hp, maxHp;
-    float speed = 75.f;
-    bool movingRight = true;
-    float attackTimer = 0.f, attackMax = 1.25f;
-    float bulletSpeed;  // Configurable bullet speed
-
-	// Constructor
-    Boss(const sf::Texture& texture, int health, float bSpeed) 
-        : sprite(texture), hp(health), maxHp(health), bulletSpeed(bSpeed) 
-    {
-        sprite.setScale({ 0.20f, 0.20f });
-        sf::FloatRect bounds = sprite.getLocalBounds();
-        sprite.setOrigin({ bounds.size.x / 2.f, bounds.size.y / 2.f });
-
-        hpBarOuter.setSize({ 200.f, 20.f });
-        hpBarOuter.setFillColor(sf::Color::Transparent);
-        hpBarOuter.setOutlineColor(sf::Color::Red);
-        hpBarOuter.setOutlineThickness(2.f);
-
-        hpBarInner.setSize({ 200.f, 20.f });
-        hpBarInner.setFillColor(sf::Color::Red);
-    }
-	// Update boss state
-    void update(sf::Time dt, sf::Vector2u windowSize, std::vector<Bullet>& enemyBullets, const sf::Texture& bulletTex) {
-        sf::Vector2f pos = sprite.getPosition();
-        float windowWidth = static_cast<float>(windowSize.x);
-		// Move boss left and right
-        if (movingRight) {
-            pos.x += speed * dt.asSeconds();
-            if (pos.x + sprite.getGlobalBounds().size.x / 2.f > windowWidth) movingRight = false;
-        } else {
-            pos.x -= speed * dt.asSeconds();
-            if (pos.x - sprite.getGlobalBounds().size.x / 2.f < 0.f) movingRight = true;
-        }
-        if (pos.y < 150.f) pos.y += 50.f * dt.asSeconds();
-        sprite.setPosition(pos);
-		// Update HP bar
-        hpBarOuter.setPosition({ pos.x - 100.f, pos.y - 100.f });
-        hpBarInner.setPosition({ pos.x - 100.f, pos.y - 100.f });
-        float hpPercent = std::max(0.f, static_cast<float>(hp) / static_cast<float>(maxHp));
-        hpBarInner.setSize({ 200.f * hpPercent, 20.f });
-		// Handle attacks
-        attackTimer += dt.asSeconds();
-        if (attackTimer >= attackMax) {
-            attackTimer = 0.f;
-            float spawnX = pos.x;
-            float spawnY = pos.y + sprite.getGlobalBounds().size.y / 2.f;
-            
-            // Create bullets with custom speed
-            Bullet b1(bulletTex, spawnX, spawnY, 0.f, 1.f);
-            b1.speed = bulletSpeed;
-            enemyBullets.push_back(b1);
-			// Side bullets
-            float angleLeft = -25.f * 3.14159f / 180.f;
-            Bullet b2(bulletTex, spawnX, spawnY, std::sin(angleLeft), std::cos(angleLeft));
-            b2.speed = bulletSpeed;
-            enemyBullets.push_back(b2);
-			// Side bullets
-            float angleRight = 25.f * 3.14159f / 180.f;
-            Bullet b3(bulletTex, spawnX, spawnY, std::sin(angleRight), std::cos(angleRight));
-            b3.speed = bulletSpeed;
-            enemyBullets.push_back(b3);
-        }
-    }
-	// Render boss
-    void render(sf::RenderWindow& target) {
-        target.draw(sprite);
-        target.draw(hpBarOuter);
-        target.draw(hpBarInner);
-    }
-	//  damage boss
-    void takeDamage(int damage) { hp -= damage; }
-    sf::FloatRect getGlobalBounds() const { return sprite.getGlobalBounds(); }
-    sf::Vector2f getPosition() const { return sprite.getPosition(); }
-    bool isAlive() const { return hp > 0; }
-};
-
-// ============================================================================
-// PLAYER
-// ============================================================================
-struct Player {
-    const std::vector<sf::Texture>* textures;
-    sf::Sprite sprite;
-    sf::Vector2f velocity;
-	// Player attributes
-    float movementSpeed = 400.f;
-    float attackCooldown = 0.2f;
-    float attackTimer;
-    float tripleShotTimer = 0.f;
-    float rotationSpeed = 150.f;
-    int currentFrame = 2;
-    float animTimer = 0.f;
-    float animSpeed = 0.05f;
-
-	// Constructor
-    Player(const std::vector<sf::Texture>& tex) : textures(&tex), sprite(tex[2]) {
-        attackTimer = attackCooldown;
-        sprite.setScale({ 1.65f, 1.65f });
-        sf::FloatRect bounds = sprite.getLocalBounds();
-        sprite.setOrigin({ bounds.size.x / 2.f, bounds.size.y / 2.f });
-    }
-	// Get player position and bounds
-    const sf::Vector2f& getPosition() const { return sprite.getPosition(); }
-    sf::FloatRect getGlobalBounds() const { return sprite.getGlobalBounds(); }
-    sf::Angle getRotation() const { return sprite.getRotation(); }
-
-	// Set player position
-    void setPosition(float x, float y) { sprite.setPosition({ x, y }); }
-    bool canAttack() { return attackTimer >= attackCooldown; }
-    void resetAttackTimer() { attackTimer = 0.f; }
-    void activateTripleShot(float duration) { tripleShotTimer = duration; }
-    bool isTripleShotActive() const { return tripleShotTimer > 0.f; }
-	
-    // Update player state
-    void update(sf::Time dt, const sf::Vector2u& windowSize) {
-        if (attackTimer < attackCooldown) attackTimer += dt.asSeconds();
-        if (tripleShotTimer > 0.f) tripleShotTimer -= dt.asSeconds();
-		// Reset velocity
-        velocity = { 0.f, 0.f };
-        bool movingLeft = false, movingRight = false;
-
-		// Handle input
-        if (sf::Keyboard::isKeyPressed(sf::Keyboard::Key::W) || sf::Keyboard::isKeyPressed(sf::Keyboard::Key::Up)) velocity.y = -1.f;
-        if (sf::Keyboard::isKeyPressed(sf::Keyboard::Key::S) || sf::Keyboard::isKeyPressed(sf::Keyboard::Key::Down)) velocity.y = 1.f;
-        if (sf::Keyboard::isKeyPressed(sf::Keyboard::Key::A)) { velocity.x = -1.f; movingLeft = true; }
-        if (sf::Keyboard::isKeyPressed(sf::Keyboard::Key::D)) { velocity.x = 1.f; movingRight = true; }
-        if (sf::Keyboard::isKeyPressed(sf::Keyboard::Key::Left)) sprite.rotate(sf::degrees(-rotationSpeed * dt.asSeconds()));
-        if (sf::Keyboard::isKeyPressed(sf::Keyboard::Key::Right)) sprite.rotate(sf::degrees(rotationSpeed * dt.asSeconds()));
-		
-        // Update animation frame
-        animTimer += dt.asSeconds();
-        if (animTimer >= animSpeed) {
-            animTimer = 0.f;
-            int targetFrame = 2;
-            if (movingLeft) targetFrame = 0;
-            else if (movingRight) targetFrame = 4;
-            if (currentFrame < targetFrame) currentFrame++;
-            else if (currentFrame > targetFrame) currentFrame--;
-            if (textures && currentFrame >= 0 && currentFrame < static_cast<int>(textures->size()))
-                sprite.setTexture((*textures)[currentFrame]);
-        }
-		// Normalize velocity and move player
-        if (velocity.x != 0.f || velocity.y != 0.f) {
-            float length = std::sqrt(velocity.x * velocity.x + velocity.y * velocity.y);
-            velocity /= length;
-            sprite.move(velocity * movementSpeed * dt.asSeconds());
-        }
-		// Keep player within window bounds
-        sf::Vector2f pos = sprite.getPosition();
-        sf::FloatRect bounds = sprite.getGlobalBounds();
-        float halfW = bounds.size.x / 2.f, halfH = bounds.size.y / 2.f;
-        if (pos.x - halfW < 0.f) pos.x = halfW;
-        if (pos.x + halfW > static_cast<float>(windowSize.x)) pos.x = static_cast<float>(windowSize.x) - halfW;
-        if (pos.y - halfH < 0.f) pos.y = halfH;
-        if (pos.y + halfH > static_cast<float>(windowSize.y)) pos.y = static_cast<float>(windowSize.y) - halfH;
-        sprite.setPosition(pos);
-    }
-	// Render player
-    void render(sf::RenderWindow& target) { target.draw(sprite); }
-};
-
-// ============================================================================
-// STAR FIELD
-// ============================================================================
-struct Star {
-    sf::CircleShape shape;
-    float speed;
-};
-
-struct StarField {
-    std::vector<Star> stars;
-    sf::Vector2u windowSize;
-	// Constructor
-    StarField(int count, sf::Vector2u winSize) : windowSize(winSize) {
-        stars.resize(count);
-        for (auto& star : stars) {
-            float x = static_cast<float>(rand() % windowSize.x);
-            float y = static_cast<float>(rand() % windowSize.y);
-            float size = static_cast<float>((rand() % 3) + 1);
-            star.shape.setRadius(size);
-            star.shape.setPosition({ x, y });
-            int brightness = (rand() % 100) + 155;
-            star.shape.setFillColor(sf::Color(255, 255, 255, brightness));
-            star.speed = size * 40.f;
-        }
-    }
-	// Update star positions
-    void update(sf::Time dt) {
-        for (auto& star : stars) {
-            star.shape.move({ 0.f, star.speed * dt.asSeconds() });
-            if (star.shape.getPosition().y > windowSize.y) {
-                float x = static_cast<float>(rand() % windowSize.x);
-                star.shape.setPosition({ x, -5.f });
-            }
-        }
-    }
-	// Render stars
-    void render(sf::RenderWindow& target) {
-        for (const auto& star : stars) target.draw(star.shape);
-    }
-};
-
-// ============================================================================
-// SCROLLING BACKGROUND
-// ============================================================================
-struct ScrollingBackground {
-    sf::Sprite bg1, bg2;
-    float scrollSpeed;
-    float textureHeight;
-	// Constructor
-    ScrollingBackground(const sf::Texture& texture, float speed)
-        : bg1(texture), bg2(texture), scrollSpeed(speed)
-    {
-        textureHeight = static_cast<float>(texture.getSize().y);
-        bg1.setPosition({ 0.f, 0.f });
-        bg2.setPosition({ 0.f, -textureHeight });
-    }
-	// Update background positions
-    void update(sf::Time dt) {
-        float movement = scrollSpeed * dt.asSeconds();
-        bg1.move({ 0.f, movement });
-        bg2.move({ 0.f, movement });
-        sf::Vector2f pos1 = bg1.getPosition(), pos2 = bg2.getPosition();
-        if (pos1.y >= textureHeight) bg1.setPosition({ 0.f, pos2.y - textureHeight });
-        if (pos2.y >= textureHeight) bg2.setPosition({ 0.f, pos1.y - textureHeight });
-    }
-	// Render background
-    void render(sf::RenderWindow& target) {
-        target.draw(bg1);
-        target.draw(bg2);
-    }
-};
-
-// ============================================================================
-// SCREEN SHAKE
-// ============================================================================
-struct ScreenShake {
-    float shakeAmount = 0.f;
-    float shakeDuration = 0.f;
-    float shakeTimer = 0.f;
-    float maxShakeDuration = 0.f;
-	// Start screen shake
-    void shake(float amount, float duration) {
-        shakeAmount = amount;
-        shakeDuration = duration;
-        maxShakeDuration = duration;
-        shakeTimer = 0.f;
-    }
-	// Update shake timer
-    void update(sf::Time dt) {
-        if (shakeTimer < shakeDuration) shakeTimer += dt.asSeconds();
-    }
-	// Get current shake offset
-    sf::Vector2f getOffset() const {
-        if (shakeTimer >= shakeDuration) return { 0.f, 0.f };
-        float intensity = (shakeDuration - shakeTimer) / maxShakeDuration;
-        float offsetX = std::sin(shakeTimer * 50.f) * shakeAmount * intensity;
-        float offsetY = std::sin(shakeTimer * 70.f) * shakeAmount * intensity;
-        return { offsetX, offsetY };
-    }
-};
-
-// ============================================================================
-// HUD
-// ============================================================================
-struct HUD {
-    sf::Font font;
-    sf::Text scoreText;
-    sf::Texture heartTex;
-    std::vector<sf::Sprite> hearts;
-    int score = 0;
-    int currentHearts = 10;
-    int maxHearts = 10;
-    int enemiesDefeated = 0;
-
-    // Power-up notification
-    sf::Text powerupText;
-    float powerupMessageTimer = 0.f;
-    float powerupMessageDuration = 2.f;  // Show message for 2 seconds
-    bool showPowerupMessage = false;
-
-	// Constructor
-    HUD() : scoreText(font), powerupText(font) {
-        font.openFromFile("assests/font/Xirod.otf");
-        scoreText.setCharacterSize(24);
-        scoreText.setFillColor(sf::Color::White);
-        scoreText.setPosition({ 10.f, 10.f });
-
-        // Setup power-up text
-        powerupText.setCharacterSize(18);
-        powerupText.setFillColor(sf::Color::Yellow);
-        powerupText.setOutlineColor(sf::Color::Black);
-        powerupText.setOutlineThickness(1.f);
-		powerupText.setPosition({ 10.f, 85.f }); // Below hearts
-    }
-
-	// Load HUD assets
-    bool loadAssets() {
-        if (!heartTex.loadFromFile("assests/textures/player/heart.png")) return false;
-        hearts.clear();
-        for (int i = 0; i < maxHearts; i++) {
-            sf::Sprite heart(heartTex);
-            heart.setScale({ 0.5f, 0.5f });
-            heart.setPosition({ 10.f + (i * 25.f), 50.f });
-            hearts.push_back(heart);
-        }
-        return true;
-    }
-
-	// Display power-up message
-    void showPowerup(const std::string& message) {
-        powerupText.setString(message);
-        showPowerupMessage = true;
-        powerupMessageTimer = 0.f;
-    }
-
-	// Score and health management
-    void addScore(int points) { score += points; scoreText.setString("Score: " + std::to_string(score)); }
-    int getScore() const { return score; }
-    void loseHeart() { if (currentHearts > 0) currentHearts--; }
-    bool isAlive() const { return currentHearts > 0; }
-    void heal(int amount) { currentHearts = std::min(currentHearts + amount, maxHearts); }
-    void addEnemyDefeated() { enemiesDefeated++; }
-    const sf::Font& getFont() const { return font; }
-
-	// Dynamic spawn rate multiplier based on score
-    float getSpawnRateMultiplier() const {
-    // Increase spawn rate based on score
-    // Every 100 points increases spawn rate by 0.2
-        float multiplier = 1.0f + (score / 100) * 0.2f;
-        // Cap at 2.2 maximum
-        return std::min(multiplier, 2.2f);
-    }
-
-	// Update HUD elements
-    void update(sf::Time dt) { 
-        scoreText.setString("Score: " + std::to_string(score)); 
-
-        // Update power-up message timer
-        if (showPowerupMessage) {
-            powerupMessageTimer += dt.asSeconds();
-            if (powerupMessageTimer >= powerupMessageDuration) {
-                showPowerupMessage = false;
-            }
-        }
-    }
-
-	// Render HUD elements
-    void render(sf::RenderWindow& target) {
-        target.draw(scoreText);
-        for (int i = 0; i < currentHearts; i++) target.draw(hearts[i]);
-
-        // Draw power-up message with fade effect
-        if (showPowerupMessage) {
-            float alpha = 1.f - (powerupMessageTimer / powerupMessageDuration);
-            sf::Color color = powerupText.getFillColor();
-            color.a = static_cast<std::uint8_t>(255 * alpha);
-            powerupText.setFillColor(color);
-
-            sf::Color outlineColor = powerupText.getOutlineColor();
-            outlineColor.a = static_cast<std::uint8_t>(255 * alpha);
-            powerupText.setOutlineColor(outlineColor);
-
-            target.draw(powerupText);
-        }
-    }
-
-	// Reset HUD state
-    void reset() {
-        score = 0;
-        currentHearts = maxHearts;
-        enemiesDefeated = 0;
-        scoreText.setString("Score: 0");
-        showPowerupMessage = false;
-        powerupMessageTimer = 0.f;
-    }
-};
-
-// ============================================================================
-// MENU BUTTON
-// ============================================================================
-struct MenuIconButton {
-    sf::RectangleShape* rectangle = nullptr;
-    sf::Vector2f originalScale = { 1.f, 1.f };
-    sf::Vector2f originalPosition;
-    float animationTimer = 0.f;
-    float animationDuration = 0.15f;
-    bool isAnimating = false;
-    bool isSelected = false;
-    std::string label;
-};
-
-// ============================================================================
-// MENU
-// ============================================================================
-struct Menu {
-    sf::Font font;
-    sf::Sprite* menuBackground = nullptr;
-    std::vector<MenuIconButton> iconButtons;
-    int selectedIconIndex = 0;
-    bool startPressed = false;
-    bool exitPressed = false;
-    bool highScorePressed = false;
-    bool optionsPressed = false;  // Add this member variable
-
-    ~Menu() {
-        if (menuBackground) delete menuBackground;
-        for (auto& btn : iconButtons) if (btn.rectangle) delete btn.rectangle;
-    }
-
-    bool loadAssets(const sf::Texture& menuBgTexture) {
-        font.openFromFile("assests/font/Xirod.otf");
-        menuBackground = new sf::Sprite(menuBgTexture);
-        float scaleX = 1200.f / static_cast<float>(menuBgTexture.getSize().x);
-        float scaleY = 900.f / static_cast<float>(menuBgTexture.getSize().y);
-        menuBackground->setScale({ scaleX, scaleY });
-
-        std::vector<std::string> buttonLabels = { "START GAME", "OPTIONS", "HIGH SCORE", "EXIT GAME" };
-        float buttonWidth = 240.f, buttonHeight = 55.f, buttonX = 95.f, startY = 575.f, spacing = 67.f;
-
-        for (size_t i = 0; i < 4; i++) {
-            sf::RectangleShape* rect = new sf::RectangleShape({ buttonWidth, buttonHeight });
-            rect->setFillColor(sf::Color::Transparent);
-            rect->setPosition({ buttonX, startY + (i * spacing) });
-
-            MenuIconButton btn;
-            btn.rectangle = rect;
-            btn.originalPosition = rect->getPosition();
-            btn.isSelected = (i == 0);
-            btn.label = buttonLabels[i];
-            iconButtons.push_back(btn);
-        }
-        return true;
-    }
-
-    void handleInput(const sf::Event& event, const sf::RenderWindow& window) {
-        if (const auto* keyEvent = event.getIf<sf::Event::KeyPressed>()) {
-            if (keyEvent->code == sf::Keyboard::Key::Up) {
-                selectedIconIndex = (selectedIconIndex - 1 + 4) % 4;
-                for (size_t i = 0; i < iconButtons.size(); i++) iconButtons[i].isSelected = (static_cast<int>(i) == selectedIconIndex);
-            } else if (keyEvent->code == sf::Keyboard::Key::Down) {
-                selectedIconIndex = (selectedIconIndex + 1) % 4;
-                for (size_t i = 0; i < iconButtons.size(); i++) iconButtons[i].isSelected = (static_cast<int>(i) == selectedIconIndex);
-            } else if (keyEvent->code == sf::Keyboard::Key::Enter) {
-                if (selectedIconIndex == 0) startPressed = true;
-                else if (selectedIconIndex == 1) optionsPressed = true;  // Add this
-                else if (selectedIconIndex == 2) highScorePressed = true;
-                else if (selectedIconIndex == 3) exitPressed = true;
-            }
-        }
-
-        if (const auto* moveEvent = event.getIf<sf::Event::MouseMoved>()) {
-            sf::Vector2f mousePos = window.mapPixelToCoords({ moveEvent->position.x, moveEvent->position.y });
-            for (size_t i = 0; i < iconButtons.size(); i++) {
-                if (iconButtons[i].rectangle && iconButtons[i].rectangle->getGlobalBounds().contains(mousePos)) {
-                    selectedIconIndex = static_cast<int>(i);
-                    for (size_t j = 0; j < iconButtons.size(); j++) iconButtons[j].isSelected = (j == i);
-                }
-            }
-        }
-
-        if (const auto* clickEvent = event.getIf<sf::Event::MouseButtonPressed>()) {
-            if (clickEvent->button == sf::Mouse::Button::Left) {
-                sf::Vector2f mousePos = window.mapPixelToCoords({ clickEvent->position.x, clickEvent->position.y });
-                for (size_t i = 0; i < iconButtons.size(); i++) {
-                    if (iconButtons[i].rectangle && iconButtons[i].rectangle->getGlobalBounds().contains(mousePos)) {
-                        if (i == 0) startPressed = true;
-                        else if (i == 1) optionsPressed = true;  // Add this
-                        else if (i == 2) highScorePressed = true;
-                        else if (i == 3) exitPressed = true;
-                    }
-                }
-            }
-        }
-    }
-    
-    void update(sf::Time dt) {}
-
-    void render(sf::RenderWindow& target) {
-        if (menuBackground) target.draw(*menuBackground);
-        for (auto& btn : iconButtons) {
-            if (btn.rectangle) {
-                target.draw(*btn.rectangle);
-                if (btn.isSelected) {
-                    sf::FloatRect rectBounds = btn.rectangle->getGlobalBounds();
-                    sf::RectangleShape highlight(rectBounds.size);
-                    highlight.setPosition(rectBounds.position);
-                    highlight.setFillColor(sf::Color::Transparent);
-                    highlight.setOutlineColor(sf::Color::White);
-                    highlight.setOutlineThickness(3.f);
-                    target.draw(highlight);
-                }
-            }
-        }
-    }
-
-    bool isStartPressed() const { return startPressed; }
-    bool isHighScorePressed() const { return highScorePressed; }
-    bool isOptionsPressed() const { return optionsPressed; }
-    bool isExitPressed() const { return exitPressed; }
-    
-    void reset() { 
-        startPressed = exitPressed = highScorePressed = optionsPressed = false;
-        selectedIconIndex = 0; 
-    }
-};
-
-// ============================================================================
-// PAUSE MENU
-// ============================================================================
-struct PauseMenuButton {
-    sf::RectangleShape shape;
-    sf::Text* text = nullptr;
-    bool isHovered = false;
-    int action = 0; // 0=NONE, 1=CONTINUE, 2=TOGGLE_MUSIC, 3=EXIT_GAME
-};
-
-struct PauseMenu {
-    enum Action { NONE = 0, CONTINUE = 1, TOGGLE_MUSIC = 2, EXIT_GAME = 3 };
-	// Pause menu attributes
-    sf::Font font;
-    sf::Text* titleText = nullptr;
-    std::vector<PauseMenuButton> buttons;
-    sf::RectangleShape pauseBar1, pauseBar2;
-    sf::FloatRect pauseIconBounds;
-    int selectedIndex = 0;
-    bool isPaused_ = false;
-    bool musicOn = true;
-    Action lastAction = NONE;
-    float iconPulseTimer = 0.f;
-    float iconAlpha = 200.f;
-	// Constructor
-    PauseMenu() {
-        float barWidth = 12.f, barHeight = 35.f, barSpacing = 8.f, iconX = 1140.f, iconY = 20.f;
-        pauseBar1.setSize({ barWidth, barHeight });
-        pauseBar1.setFillColor(sf::Color(255, 255, 255, 200));
-        pauseBar1.setPosition({ iconX, iconY });
-        pauseBar2.setSize({ barWidth, barHeight });
-        pauseBar2.setFillColor(sf::Color(255, 255, 255, 200));
-        pauseBar2.setPosition({ iconX + barWidth + barSpacing, iconY });
-        pauseIconBounds = sf::FloatRect({ iconX - 5.f, iconY - 5.f }, { (barWidth * 2) + barSpacing + 10.f, barHeight + 10.f });
-    }
-	// Destructor
-    ~PauseMenu() {
-        if (titleText) delete titleText;
-        for (auto& btn : buttons) if (btn.text) delete btn.text;
-    }
-	// Load pause menu assets
-    bool loadAssets(const sf::Font& f) {
-        font = f;
-        titleText = new sf::Text(font, "GAME PAUSED", 60);
-        titleText->setFillColor(sf::Color::White);
-        titleText->setOutlineColor(sf::Color::Black);
-        titleText->setOutlineThickness(3.f);
-        sf::FloatRect titleBounds = titleText->getLocalBounds();
-        titleText->setOrigin({ titleBounds.size.x / 2.f, titleBounds.size.y / 2.f });
-        titleText->setPosition({ 600.f, 200.f });
-		// Define buttons
-        std::vector<std::pair<std::string, Action>> buttonData = { {"CONTINUE", CONTINUE}, {"MUSIC: ON", TOGGLE_MUSIC}, {"EXIT GAME", EXIT_GAME} };
-        float buttonWidth = 300.f, buttonHeight = 60.f, startY = 350.f, spacing = 80.f;
-		// Create buttons
-        for (size_t i = 0; i < buttonData.size(); i++) {
-            PauseMenuButton btn;
-            btn.shape.setSize({ buttonWidth, buttonHeight });
-            btn.shape.setFillColor(sf::Color(0, 0, 0, 100));
-            btn.shape.setOutlineColor(sf::Color(255, 255, 255, 150));
-            btn.shape.setOutlineThickness(2.f);
-            btn.shape.setOrigin({ buttonWidth / 2.f, buttonHeight / 2.f });
-            btn.shape.setPosition({ 600.f, startY + (i * spacing) });
-            btn.text = new sf::Text(font, buttonData[i].first, 28);
-            btn.text->setFillColor(sf::Color::White);
-            sf::FloatRect textBounds = btn.text->getLocalBounds();
-            btn.text->setOrigin({ textBounds.size.x / 2.f, textBounds.size.y / 2.f });
-            btn.text->setPosition({ 600.f, startY + (i * spacing) - 5.f });
-            btn.action = buttonData[i].second;
-            buttons.push_back(btn);
-        }
-        return true;
-    }
-	// Handle input for pause menu
-    void handleInput(const sf::Event& event, const sf::RenderWindow& window) {
-        if (!isPaused_) {
-            if (const auto* clickEvent = event.getIf<sf::Event::MouseButtonPressed>()) {
-                if (clickEvent->button == sf::Mouse::Button::Left) {
-                    sf::Vector2f mousePos = window.mapPixelToCoords({ clickEvent->position.x, clickEvent->position.y });
-                    if (pauseIconBounds.contains(mousePos)) isPaused_ = true;
-                }
-            }
-            if (const auto* keyEvent = event.getIf<sf::Event::KeyPressed>()) {
-                if (keyEvent->code == sf::Keyboard::Key::Escape || keyEvent->code == sf::Keyboard::Key::P) isPaused_ = true;
-            }
-            return;
-        }
-		// Handle pause menu keyboard input
-        if (const auto* keyEvent = event.getIf<sf::Event::KeyPressed>()) {
-            if (keyEvent->code == sf::Keyboard::Key::Up) {
-                selectedIndex = (selectedIndex - 1 + static_cast<int>(buttons.size())) % static_cast<int>(buttons.size());
-            } else if (keyEvent->code == sf::Keyboard::Key::Down) {
-                selectedIndex = (selectedIndex + 1) % static_cast<int>(buttons.size());
-            } else if (keyEvent->code == sf::Keyboard::Key::Enter) {
-                lastAction = static_cast<Action>(buttons[selectedIndex].action);
-                if (lastAction == TOGGLE_MUSIC) {
-                    musicOn = !musicOn;
-                    buttons[selectedIndex].text->setString(musicOn ? "MUSIC: ON" : "MUSIC: OFF");
-                } else if (lastAction == CONTINUE) {
-                    isPaused_ = false;
-                }
-            } else if (keyEvent->code == sf::Keyboard::Key::Escape) {
-                isPaused_ = false;
-                lastAction = CONTINUE;
-            }
-        }
-		// Handle pause menu mouse movement
-        if (const auto* clickEvent = event.getIf<sf::Event::MouseButtonPressed>()) {
-            if (clickEvent->button == sf::Mouse::Button::Left) {
-                sf::Vector2f mousePos = window.mapPixelToCoords({ clickEvent->position.x, clickEvent->position.y });
-                for (size_t i = 0; i < buttons.size(); i++) {
-                    if (buttons[i].shape.getGlobalBounds().contains(mousePos)) {
-                        lastAction = static_cast<Action>(buttons[i].action);
-                        if (lastAction == TOGGLE_MUSIC) {
-                            musicOn = !musicOn;
-                            buttons[i].text->setString(musicOn ? "MUSIC: ON" : "MUSIC: OFF");
-                        } else if (lastAction == CONTINUE) {
-                            isPaused_ = false;
-                        }
-                    }
-                }
-            }
-        }
-    }
-	// Update pause menu state
-    void update(sf::Time dt) {
-        iconPulseTimer += dt.asSeconds();
-        iconAlpha = 180.f + 40.f * std::sin(iconPulseTimer * 3.f);
-        sf::Color iconColor(255, 255, 255, static_cast<std::uint8_t>(iconAlpha));
-        pauseBar1.setFillColor(iconColor);
-        pauseBar2.setFillColor(iconColor);
-		// Update button hover states
-        for (size_t i = 0; i < buttons.size(); i++) {
-            buttons[i].isHovered = (static_cast<int>(i) == selectedIndex);
-            if (buttons[i].isHovered) {
-                buttons[i].shape.setFillColor(sf::Color(50, 50, 80, 180));
-                buttons[i].shape.setOutlineColor(sf::Color::White);
-            } else {
-                buttons[i].shape.setFillColor(sf::Color(0, 0, 0, 100));
-                buttons[i].shape.setOutlineColor(sf::Color(255, 255, 255, 150));
-            }
-        }
-    }
-	// Render pause icon
-    void renderIcon(sf::RenderWindow& target) { target.draw(pauseBar1); target.draw(pauseBar2); }
-	// Render pause menu
-    void renderMenu(sf::RenderWindow& target) {
-        sf::RectangleShape overlay({ 1200.f, 900.f });
-        overlay.setFillColor(sf::Color(0, 0, 0, 150));
-        target.draw(overlay);
-        if (titleText) target.draw(*titleText);
-        for (auto& btn : buttons) { target.draw(btn.shape); if (btn.text) target.draw(*btn.text); }
-    }
-	// Getters and setters
-    bool isPaused() const { return isPaused_; }
-    void setPaused(bool p) { isPaused_ = p; }
-    Action getLastAction() { return lastAction; }
-    void resetAction() { lastAction = NONE; }
-    bool isMusicOn() const { return musicOn; }
-};
-
-// ============================================================================
-// GAME OVER
-// ============================================================================
-struct GameOver {
-	// Animation frames
-    const std::vector<sf::Texture>* frames = nullptr;
-    sf::Sprite* animSprite = nullptr;
-    int currentFrame = 0;
-    float duration = 0.1f;
-    float elapsedTime = 0.f;
-    Menu menu;
-    bool showMenu = false;
-	// Destructor
-    ~GameOver() { if (animSprite) delete animSprite; }
-	// Initialize game over animation and menu
-    void init(const std::vector<sf::Texture>& f, float frameDuration, const sf::Texture& gameOverBg) {
-        frames = &f;
-        duration = frameDuration;
-        if (animSprite) delete animSprite;
-        if (!frames->empty()) {
-            animSprite = new sf::Sprite((*frames)[0]);
-            animSprite->setScale({ 2.5f, 2.5f });
-            sf::FloatRect bounds = animSprite->getLocalBounds();
-            animSprite->setOrigin({ bounds.size.x / 2.f, bounds.size.y / 2.f });
-            animSprite->setPosition({ 600.f, 450.f });
-        }
-        menu.loadAssets(gameOverBg);
-        reset();
-    }
-	// Reset game over state
-    void reset() {
-        showMenu = false;
-        currentFrame = 0;
-        elapsedTime = 0.f;
-        menu.reset();
-        if (frames && !frames->empty() && animSprite) animSprite->setTexture((*frames)[0]);
-    }
-	// Handle input for game over menu
-    void handleInput(const sf::Event& event, const sf::RenderWindow& window) {
-        if (showMenu) menu.handleInput(event, window);
-    }
-	// Update game over animation and menu
-    void update(sf::Time dt) {
-        if (!showMenu) {
-            if (frames && !frames->empty() && animSprite) {
-                elapsedTime += dt.asSeconds();
-                if (elapsedTime >= duration) {
-                    elapsedTime = 0.f;
-                    currentFrame++;
-                    if (currentFrame >= static_cast<int>(frames->size())) {
-                        showMenu = true;
-                    } else {
-                        animSprite->setTexture((*frames)[currentFrame], true);
-                    }
-                }
-            } else {
-                showMenu = true;
-            }
-        }
-        menu.update(dt);
-    }
-	// Render game over animation or menu
-    void render(sf::RenderWindow& window) {
-        if (!showMenu && animSprite) window.draw(*animSprite);
-        else menu.render(window);
-    }
-	// Getters for menu actions
-    bool isRetryPressed() const { return menu.isStartPressed(); }
-    bool isOptionsPressed() const { return menu.isOptionsPressed(); }
-    bool isHighScorePressed() const { return menu.isHighScorePressed(); }
-    bool isExitPressed() const { return menu.isExitPressed(); }
-};
-
-// ============================================================================
-// OPTIONS MENU
-// ============================================================================
-struct OptionsMenu {
-	// Background
-    sf::Font font;
-    sf::Sprite* background = nullptr;
-    sf::Texture optionsBgTex;
-
-    // Buttons
-    std::vector<sf::RectangleShape> buttons;
-    std::vector<sf::Text*> buttonTexts;
-    int selectedIndex = 0;
-
-    // Music state
-    bool musicOn = true;
-
-    // Image display
-    bool showingImage = false;
-    int currentImageIndex = -1;
-    sf::Texture image1Tex, image2Tex;
-    sf::Sprite* imageSprite = nullptr;
-
-    // Actions
-    bool backPressed = false;
-	// Destructor
-    ~OptionsMenu() {
-        if (background) delete background;
-        if (imageSprite) delete imageSprite;
-        for (auto* text : buttonTexts) if (text) delete text;
-    }
-	// Load options menu assets
-    bool loadAssets(const sf::Font& f) {
-        font = f;
-
-        // Load options background from file
-        if (!optionsBgTex.loadFromFile("assests/textures/menu/options.png")) {
-            // Fallback: create a dark background if file not found
-            sf::Image img;
-            img.resize({ 1200, 900 }, sf::Color(20, 20, 40));
-            optionsBgTex.loadFromImage(img);
-        }
-		// Create background sprite
-        background = new sf::Sprite(optionsBgTex);
-        background->setScale({
-            1200.f / static_cast<float>(optionsBgTex.getSize().x),
-            900.f / static_cast<float>(optionsBgTex.getSize().y)
-        });
-
-        // Load images for controls and credits
-        if (!image1Tex.loadFromFile("assests/textures/menu/controls.png")) {
-            sf::Image img;
-            img.resize({ 800, 600 }, sf::Color(50, 50, 100));
-            image1Tex.loadFromImage(img);
-        }
-        if (!image2Tex.loadFromFile("assests/textures/menu/credits.png")) {
-            sf::Image img;
-            img.resize({ 800, 600 }, sf::Color(100, 50, 50));
-            image2Tex.loadFromImage(img);
-        }
-
-        // Create 3 buttons only: Music Toggle, Controls, Credits
-        std::vector<std::string> labels = { "MUSIC: ON", "CONTROLS", "CREDITS" };
-        float buttonWidth = 300.f, buttonHeight = 60.f;
-        float startY = 350.f, spacing = 100.f;
-		// Create buttons and texts
-        for (size_t i = 0; i < labels.size(); i++) {
-            sf::RectangleShape btn({ buttonWidth, buttonHeight });
-            btn.setFillColor(sf::Color::Transparent);  // Fully transparent
-            btn.setOutlineColor(sf::Color(255, 255, 255, 150));
-            btn.setOutlineThickness(2.f);
-            btn.setOrigin({ buttonWidth / 2.f, buttonHeight / 2.f });
-            btn.setPosition({ 600.f, startY + (i * spacing) });
-            buttons.push_back(btn);
-			// Create button text
-            sf::Text* text = new sf::Text(font, labels[i], 28);
-            text->setFillColor(sf::Color::White);
-            sf::FloatRect textBounds = text->getLocalBounds();
-            text->setOrigin({ textBounds.size.x / 2.f, textBounds.size.y / 2.f });
-            text->setPosition({ 600.f, startY + (i * spacing) - 5.f });
-            buttonTexts.push_back(text);
-        }
-
-        return true;
-    }
-	// Handle input for options menu
-    void handleInput(const sf::Event& event, const sf::RenderWindow& window) {
-        // If showing an image, ESC closes it
-        if (showingImage) {
-            if (const auto* keyEvent = event.getIf<sf::Event::KeyPressed>()) {
-                if (keyEvent->code == sf::Keyboard::Key::Escape) {
-                    showingImage = false;
-                    currentImageIndex = -1;
-                    if (imageSprite) {
-                        delete imageSprite;
-                        imageSprite = nullptr;
-                    }
-                }
-            }
-            return;
-        }
-
-        // Keyboard navigation
-        if (const auto* keyEvent = event.getIf<sf::Event::KeyPressed>()) {
-            if (keyEvent->code == sf::Keyboard::Key::Up) {
-                selectedIndex = (selectedIndex - 1 + static_cast<int>(buttons.size())) % static_cast<int>(buttons.size());
-            }
-            else if (keyEvent->code == sf::Keyboard::Key::Down) {
-                selectedIndex = (selectedIndex + 1) % static_cast<int>(buttons.size());
-            }
-            else if (keyEvent->code == sf::Keyboard::Key::Enter) {
-                executeAction(selectedIndex);
-            }
-            else if (keyEvent->code == sf::Keyboard::Key::Escape) {
-                backPressed = true;  // ESC goes back to menu
-            }
-        }
-
-        // Mouse hover
-        if (const auto* moveEvent = event.getIf<sf::Event::MouseMoved>()) {
-            sf::Vector2f mousePos = window.mapPixelToCoords({ moveEvent->position.x, moveEvent->position.y });
-            for (size_t i = 0; i < buttons.size(); i++) {
-                if (buttons[i].getGlobalBounds().contains(mousePos)) {
-                    selectedIndex = static_cast<int>(i);
-                }
-            }
-        }
-
-        // Mouse click
-        if (const auto* clickEvent = event.getIf<sf::Event::MouseButtonPressed>()) {
-            if (clickEvent->button == sf::Mouse::Button::Left) {
-                sf::Vector2f mousePos = window.mapPixelToCoords({ clickEvent->position.x, clickEvent->position.y });
-                for (size_t i = 0; i < buttons.size(); i++) {
-                    if (buttons[i].getGlobalBounds().contains(mousePos)) {
-                        executeAction(static_cast<int>(i));
-                    }
-                }
-            }
-        }
-    }
-	// Execute action based on selected button
-    void executeAction(int index) {
-        switch (index) {
-        case 0:  // Toggle Music
-            musicOn = !musicOn;
-            buttonTexts[0]->setString(musicOn ? "MUSIC: ON" : "MUSIC: OFF");
-            {
-                sf::FloatRect textBounds = buttonTexts[0]->getLocalBounds();
-                buttonTexts[0]->setOrigin({ textBounds.size.x / 2.f, textBounds.size.y / 2.f });
-            }
-            break;
-        case 1:  // Show Controls image
-            showImage(0);
-            break;
-        case 2:  // Show Credits image
-            showImage(1);
-            break;
-        }
-    }
-	// Show image overlay
-    void showImage(int imageIndex) {
-        currentImageIndex = imageIndex;
-        showingImage = true;
-		// Create sprite for the image
-        if (imageSprite) delete imageSprite;
-
-        sf::Texture& tex = (imageIndex == 0) ? image1Tex : image2Tex;
-        imageSprite = new sf::Sprite(tex);
-		// Center the image
-        sf::FloatRect bounds = imageSprite->getLocalBounds();
-        imageSprite->setOrigin({ bounds.size.x / 2.f, bounds.size.y / 2.f });
-        imageSprite->setPosition({ 600.f, 450.f });
-
-        // Scale to fit screen
-        float scaleX = 1200.f / bounds.size.x;
-        float scaleY = 900.f / bounds.size.y;
-        float scale = std::min(scaleX, scaleY);
-        imageSprite->setScale({ scale, scale });
-    }
-	// Update options menu state
-    void update(sf::Time dt) {
-        for (size_t i = 0; i < buttons.size(); i++) {
-            if (static_cast<int>(i) == selectedIndex) {
-                buttons[i].setFillColor(sf::Color(255, 255, 255, 30));  // Slight highlight when selected
-                buttons[i].setOutlineColor(sf::Color::White);
-            }
-            else {
-                buttons[i].setFillColor(sf::Color::Transparent);
-                buttons[i].setOutlineColor(sf::Color(255, 255, 255, 150));
-            }
-        }
-    }
-	// Render options menu
-    void render(sf::RenderWindow& target) {
-        if (background) target.draw(*background);
-
-        // Draw buttons
-        for (size_t i = 0; i < buttons.size(); i++) {
-            target.draw(buttons[i]);
-            if (buttonTexts[i]) target.draw(*buttonTexts[i]);
-        }
-
-        // Draw hint text
-        sf::Text hint(font, "Press ESC to go back", 20);
-        hint.setFillColor(sf::Color(200, 200, 200));
-        hint.setPosition({ 50.f, 850.f });
-        target.draw(hint);
-
-        // If showing an image, draw overlay and image
-        if (showingImage && imageSprite) {
-            sf::RectangleShape overlay({ 1200.f, 900.f });
-            overlay.setFillColor(sf::Color(0, 0, 0, 200));
-            target.draw(overlay);
-
-            target.draw(*imageSprite);
-
-            sf::Text closeHint(font, "Press ESC to close", 24);
-            closeHint.setFillColor(sf::Color::White);
-            sf::FloatRect hintBounds = closeHint.getLocalBounds();
-            closeHint.setOrigin({ hintBounds.size.x / 2.f, hintBounds.size.y / 2.f });
-            closeHint.setPosition({ 600.f, 850.f });
-            target.draw(closeHint);
-        }
-    }
-	// Getters
-    bool isBackPressed() const { return backPressed; }
-    bool isMusicOn() const { return musicOn; }
-	// Reset options menu state
-    void reset() {
-        backPressed = false;
-        selectedIndex = 0;
-        showingImage = false;
-        currentImageIndex = -1;
-        if (imageSprite) {
-            delete imageSprite;
-            imageSprite = nullptr;
-        }
-    }
-};
-
-// ============================================================================
-// MAIN GAME CLASS
-// ============================================================================
-class Game {
-public:
-	// Window and timing
-    sf::RenderWindow window;
-    sf::Clock clock;
-    GameState currentState = GameState::MENU;
-
-    // Audio
-    sf::Music gameMusic, menuMusic;
-    sf::SoundBuffer shootBuffer, explosionBuffer, bossHitBuffer;
-    sf::Sound shootSound, explosionSound, bossHitSound;
-
-    // Textures
-    sf::Texture bgTex, menuBgTex, highScoreBgTex, gameOverBgTex;
-    sf::Texture coinTex, healTex, boltTex, asteroidTex, bulletTex, playerBulletTex, bossTex;
-    std::vector<sf::Texture> playerTextures, enemyTextures;
-    std::vector<sf::Texture> explosionFrames, playerExplosionFrames, gameOverExplosionFrames;
-    sf::Sprite* highScoreSprite = nullptr;
-
-    // Game Objects
-    Player* player = nullptr;
-    ScrollingBackground* background = nullptr;
-    StarField* stars = nullptr;
-    Boss* activeBoss = nullptr;
-    std::vector<Enemy> enemies;
-    std::vector<Bullet> enemyBullets, playerBullets;
-    std::vector<Explosion> explosions;
-    std::vector<Asteroid> asteroids;
-    std::vector<Powerup> powerups;
-
-    // UI
-    Menu menu;
-    HUD hud;
-    GameOver gameOverScreen;
-    PauseMenu pauseMenu;
-    ScreenShake screenShake;
-    OptionsMenu optionsMenu; 
-
-    // State
-	int currentHighScore = 0;  // Loaded from file
-	bool bossSpawned = false;  // Track if a boss is currently spawned
-    int bossCount = 0;           // Track number of bosses defeated
-    int nextBossScore = 500;     // Score threshold for next boss
-	float spawnTimer = 0.f, spawnTimerMax = 4.25f; // Enemy spawn timer
-	float asteroidSpawnTimer = 0.f, asteroidSpawnTimerMax = 20.f; // Asteroid spawn timer
-    GameState previousState = GameState::MENU;  // Track where we came from
-
-    // Loading screen
-    float loadingTimer = 0.f; 
-    float loadingDuration = 3.f;  // 3 seconds
-    sf::Texture loadingBgTex;
-    sf::Sprite* loadingSprite = nullptr;
-
-	// Constructor
-    Game() : shootSound(shootBuffer), explosionSound(explosionBuffer), bossHitSound(bossHitBuffer) {
-        std::srand(static_cast<unsigned>(std::time(nullptr)));
-        window.create(sf::VideoMode({ 1200, 900 }), "Space Shooter", sf::Style::Close | sf::Style::Titlebar);
-        window.setFramerateLimit(144);
-        currentState = GameState::LOADING;
-        currentHighScore = loadHighScore();
-        
-        // Load and display loading screen FIRST
-        if (!loadingBgTex.loadFromFile("assests/textures/menu/loading.png")) {
-            sf::Image img;
-            img.resize({ 1200, 900 }, sf::Color(20, 20, 40));
-            loadingBgTex.loadFromImage(img);
-        }
-        loadingSprite = new sf::Sprite(loadingBgTex);
-        loadingSprite->setScale({
-            1200.f / static_cast<float>(loadingBgTex.getSize().x),
-            900.f / static_cast<float>(loadingBgTex.getSize().y)
-        });
-        
-        // Render loading screen immediately
-        window.clear();
-        window.draw(*loadingSprite);
-        window.display();
-        
-        // Now load all other assets (loading screen is visible during this)
-        loadAssets();
-        initObjects();
-        
-        // Transition to menu
-        currentState = GameState::MENU;
-        menuMusic.play();
-    }
-	// Destructor
-    ~Game() {
-        if (player) delete player;
-        if (background) delete background;
-        if (stars) delete stars;
-        if (activeBoss) delete activeBoss;
-		if (highScoreSprite) delete highScoreSprite;
-		if (loadingSprite) delete loadingSprite;
-    }
-	// Load high score from file
-    int loadHighScore() {
-        std::ifstream file("highscore.txt");
-        int score = 0;
-        if (file.is_open()) { file >> score; file.close(); }
-        return score;
-    }
-	// Save high score to file
-    void saveHighScore(int score) {
-        std::ofstream file("highscore.txt");
-        if (file.is_open()) { file << score; file.close(); }
-    }
-	// LOAD ALL ASSETS
-    void loadAssets() {
-        // Audio
-        gameMusic.openFromFile("assests/audio/gamebm.mp3");
-        gameMusic.setLooping(true); gameMusic.setVolume(40.f);
-        menuMusic.openFromFile("assests/audio/menubm.mp3");
-        menuMusic.setLooping(true); menuMusic.setVolume(50.f);
-        shootBuffer.loadFromFile("assests/audio/shoot.mp3");
-        shootSound.setBuffer(shootBuffer); shootSound.setVolume(10.f);
-        explosionBuffer.loadFromFile("assests/audio/explosion.mp3");
-        explosionSound.setBuffer(explosionBuffer); explosionSound.setVolume(80.f);
-        bossHitBuffer.loadFromFile("assests/audio/explosion.mp3");
-        bossHitSound.setBuffer(bossHitBuffer); bossHitSound.setPitch(2.0f); bossHitSound.setVolume(60.f);
-
-        // Textures
-        if (!bgTex.loadFromFile("assests/textures/background/background22.png")) {
-            sf::Image img; img.resize({ 800, 600 }, sf::Color::Black); bgTex.loadFromImage(img);
-        }
-        if (!menuBgTex.loadFromFile("assests/textures/menu/menubg.png")) menuBgTex = bgTex;
-        if (!highScoreBgTex.loadFromFile("assests/textures/menu/highscore.png")) highScoreBgTex = menuBgTex;
-        
-        // Set texture AFTER loading it
-        highScoreSprite = new sf::Sprite(highScoreBgTex);
-        highScoreSprite->setScale({ 
-            1200.f / static_cast<float>(highScoreBgTex.getSize().x), 
-            900.f / static_cast<float>(highScoreBgTex.getSize().y) 
-        });
-		// Game over background
-        if (!gameOverBgTex.loadFromFile("assests/textures/menu/menubg4.png")) gameOverBgTex = menuBgTex;
-		// Power-up, asteroid and boss textures
-        coinTex.loadFromFile("assests/textures/powerups/p3.png");
-        healTex.loadFromFile("assests/textures/powerups/p2.png");
-        boltTex.loadFromFile("assests/textures/powerups/p1.png");
-        asteroidTex.loadFromFile("assests/textures/enemy/asteroid.png");
-        bulletTex.loadFromFile("assests/textures/enemy/bullet2.png");
-        playerBulletTex.loadFromFile("assests/textures/player/bullet2.png");
-        bossTex.loadFromFile("assests/textures/enemy/boss.png");
-
-        // Explosion frames
-        for (int i = 1; i <= 5; i++) {
-            sf::Texture tex;
-            if (tex.loadFromFile("assests/textures/enemy animation/explosion" + std::to_string(i) + ".png"))
-                explosionFrames.push_back(tex);
-        }
-        playerExplosionFrames = explosionFrames;
-
-        // Game over explosion
-        sf::Image explosionSheet;
-        if (explosionSheet.loadFromFile("assests/textures/player/explosion.jpg")) {
-            explosionSheet.createMaskFromColor(sf::Color::White);
-            int cols = 3, rows = 2;
-            int fw = explosionSheet.getSize().x / cols, fh = explosionSheet.getSize().y / rows;
-            for (int y = 0; y < rows; y++) {
-                for (int x = 0; x < cols; x++) {
-                    sf::Image tempImg; tempImg.resize({ static_cast<unsigned>(fw), static_cast<unsigned>(fh) });
-                    tempImg.copy(explosionSheet, { 0, 0 }, sf::IntRect({ x * fw, y * fh }, { fw, fh }));
-                    sf::Texture frame; frame.loadFromImage(tempImg);
-                    gameOverExplosionFrames.push_back(frame);
-                }
-            }
-        } else {
-            gameOverExplosionFrames = playerExplosionFrames;
-        }
-
-        // Player textures
-        sf::Texture t1, t2, t3, t4, t5;
-        t1.loadFromFile("assests/textures/player/spaceship1.png");
-        t2.loadFromFile("assests/textures/player/spaceship2.png");
-        t3.loadFromFile("assests/textures/player/spaceship3.png");
-        t4.loadFromFile("assests/textures/player/spaceship4.png");
-        t5.loadFromFile("assests/textures/player/spaceship5.png");
-        playerTextures = { t1, t2, t3, t4, t5 };
-
-        // Enemy textures
-        for (int i = 1; i <= 6; i++) {
-            sf::Texture tex;
-            if (tex.loadFromFile("assests/textures/enemy/enemy" + std::to_string(i) + ".png"))
-                enemyTextures.push_back(tex);
-            else enemyTextures.push_back(t3);
-        }
-    }
-
-	// Initialize game objects
-    void initObjects() {
-        menu.loadAssets(menuBgTex);
-        hud.loadAssets();
-        gameOverScreen.init(gameOverExplosionFrames, 0.10f, gameOverBgTex);
-        pauseMenu.loadAssets(hud.getFont());
-        optionsMenu.loadAssets(hud.getFont());  // Changed - only pass font now
-
-        player = new Player(playerTextures);
-        player->setPosition(600.f, 750.f);
-        background = new ScrollingBackground(bgTex, 50.f);
-        stars = new StarField(25, window.getSize());
-    }
-
-	// Reset game state
-    void resetGame() {
-        enemies.clear();
-        if (activeBoss) { delete activeBoss; activeBoss = nullptr; }
-        bossSpawned = false;
-        bossCount = 0;              // Reset boss counter
-        nextBossScore = 500;        // Reset next boss threshold
-        enemyBullets.clear(); playerBullets.clear();
-        explosions.clear(); asteroids.clear(); powerups.clear();
-        hud.reset(); hud.loadAssets();
-        player->setPosition(600.f, 750.f);
-    }
-
-	// Main game loop
-    void run() {
-        while (window.isOpen()) {
-            sf::Time dt = clock.restart();
-            processEvents();
-            update(dt);
-            render();
-        }
-    }
-
-	// Event processing
-    void processEvents() {
-        while (const std::optional event = window.pollEvent()) {
-            if (event->is<sf::Event::Closed>()) window.close();
-
-            if (currentState == GameState::MENU) menu.handleInput(*event, window);
-            else if (currentState == GameState::PLAYING) pauseMenu.handleInput(*event, window);
-            else if (currentState == GameState::GAME_OVER) gameOverScreen.handleInput(*event, window);
-            else if (currentState == GameState::OPTIONS) optionsMenu.handleInput(*event, window);  // Add this
-            else if (currentState == GameState::HIGHSCORE) {
-                if (const auto* keyEvent = event->getIf<sf::Event::KeyPressed>()) {
-                    if (keyEvent->code == sf::Keyboard::Key::Escape) {
-						currentState = previousState;  // Return to previous state
-                        if (previousState == GameState::MENU) {
-                            menu.reset();
-                        }
-                        else if (previousState == GameState::GAME_OVER) {
-                            gameOverScreen.menu.reset();  // Reset the game over menu's button states
-                        }
-                    }
-                }
-            }
-        }
-    }
-
-	// Update function
-    void update(sf::Time dt) {
-        // game state menu
-        if (currentState == GameState::MENU) {
-            menu.update(dt);
-            if (menuMusic.getStatus() != sf::Music::Status::Playing) menuMusic.play();
-            if (menu.isStartPressed()) {
-                currentState = GameState::PLAYING;
-                menuMusic.stop(); gameMusic.play(); menu.reset();
-            }
-            if (menu.isHighScorePressed()) { 
-                previousState = GameState::MENU;
-                currentState = GameState::HIGHSCORE; menu.reset(); 
-            }
-            if (menu.isOptionsPressed()) {
-                previousState = GameState::MENU;
-                currentState = GameState::OPTIONS; menu.reset(); 
-            }
-            if (menu.isExitPressed()) window.close();
-        }
-        // game state options
-        else if (currentState == GameState::OPTIONS) {
-            optionsMenu.update(dt);
-            // Apply music setting
-            menuMusic.setVolume(optionsMenu.isMusicOn() ? 50.f : 0.f);
-            if (optionsMenu.isBackPressed()) {
-                currentState = previousState;
-                optionsMenu.reset();
-            }
-        }
-		// game state playing
-        else if (currentState == GameState::PLAYING) {
-            updatePlaying(dt);
-        }
-
-		// game state game over
-        else if (currentState == GameState::GAME_OVER) {
-            gameOverScreen.update(dt);
-            gameMusic.stop();
-            if (menuMusic.getStatus() != sf::Music::Status::Playing) menuMusic.play();
-            if (gameOverScreen.isRetryPressed()) { 
-                menuMusic.stop();
-                resetGame();
-                currentState = GameState::PLAYING;
-                gameMusic.play();
-            }
-            else if (gameOverScreen.isOptionsPressed()) {
-                previousState = GameState::GAME_OVER;
-                currentState = GameState::OPTIONS;
-                gameOverScreen.menu.reset();
-            }
-            else if (gameOverScreen.isHighScorePressed()) {
-                previousState = GameState::GAME_OVER;
-                currentState = GameState::HIGHSCORE; 
-                gameOverScreen.menu.reset(); 
-			}
-            else if (gameOverScreen.isExitPressed()) window.close();
-        }
-    }
-
-	// Update playing state
-    void updatePlaying(sf::Time dt) {
-		// Handle pause menu
-        pauseMenu.update(dt);
-		// Check pause menu actions
-        auto pauseAction = pauseMenu.getLastAction();
-        if (pauseAction == PauseMenu::TOGGLE_MUSIC) {
-            gameMusic.setVolume(pauseMenu.isMusicOn() ? 40.f : 0.f);
-            pauseMenu.resetAction();
-        }
-        else if (pauseAction == PauseMenu::EXIT_GAME) {
-            resetGame(); currentState = GameState::MENU;
-            pauseMenu.resetAction(); pauseMenu.setPaused(false);
-        }
-		// If paused, skip updates
-        if (pauseMenu.isPaused()) return;
-		// Update game objects
-        background->update(dt);
-        stars->update(dt);
-        player->update(dt, window.getSize());
-        hud.update(dt);
-        screenShake.update(dt);
-
-        // Player shooting
-        if (player->canAttack()) {
-            player->resetAttackTimer();
-            shootSound.play();
-            float angleRad = player->getRotation().asRadians();
-            float dirX = std::sin(angleRad), dirY = -std::cos(angleRad);
-            playerBullets.emplace_back(playerBulletTex, player->getPosition().x - 12.5f, player->getPosition().y, dirX, dirY);
-            if (player->isTripleShotActive()) {
-                float offsetRad = 15.f * (3.14159f / 180.f);
-                playerBullets.emplace_back(playerBulletTex, player->getPosition().x - 15.f, player->getPosition().y,
-                    std::sin(angleRad - offsetRad), -std::cos(angleRad - offsetRad));
-                playerBullets.emplace_back(playerBulletTex, player->getPosition().x - 15.f, player->getPosition().y,
-                    std::sin(angleRad + offsetRad), -std::cos(angleRad + offsetRad));
-            }
-        }
-
-        // Enemy spawning
-        if (!activeBoss) {
-            spawnTimer += dt.asSeconds();
-            if (spawnTimer >= spawnTimerMax / hud.getSpawnRateMultiplier()) {
-                spawnTimer = 0.f;
-                float randX = static_cast<float>(rand() % (window.getSize().x - 50));
-                int texIndex = enemyTextures.empty() ? 0 : rand() % static_cast<int>(enemyTextures.size());
-                enemies.emplace_back(enemyTextures[texIndex], randX, -50.f);
-            }
-        }
-
-        // Update enemies
-        for (size_t i = 0; i < enemies.size(); i++) {
-            enemies[i].update(dt, enemyBullets, bulletTex);
-            if (player->getGlobalBounds().findIntersection(enemies[i].getGlobalBounds())) {
-                for (int k = 0; k < 5 && hud.isAlive(); k++) hud.loseHeart();
-                explosionSound.play();
-                explosions.emplace_back(&explosionFrames, enemies[i].getPosition().x, enemies[i].getPosition().y);
-                screenShake.shake(4.f, 0.3f);
-                if (!hud.isAlive()) { gameOverScreen.reset(); currentState = GameState::GAME_OVER; }
-                enemies.erase(enemies.begin() + i); i--;
-            }
-            else if (enemies[i].getPosition().y > window.getSize().y) {
-                enemies.erase(enemies.begin() + i); i--;
-            }
-        }
-		// Update enemy bullets
-        if (!hud.isAlive()) {
-            if (hud.getScore() > currentHighScore) { currentHighScore = hud.getScore(); saveHighScore(currentHighScore); }
-            gameOverScreen.reset(); currentState = GameState::GAME_OVER;
-        }
-
-        // Asteroid spawning
-        asteroidSpawnTimer += dt.asSeconds();
-        if (asteroidSpawnTimer >= asteroidSpawnTimerMax) {
-            asteroidSpawnTimer = 0.f;
-            asteroids.emplace_back(asteroidTex, static_cast<float>(rand() % window.getSize().x), -50.f);
-        }
-
-        // Update Asteroids 
-        for (auto it = asteroids.begin(); it != asteroids.end();) {
-            it->update(dt);
-            if (player->getGlobalBounds().findIntersection(it->getGlobalBounds())) {
-                for (int k = 0; k < 5 && hud.isAlive(); k++) hud.loseHeart();
-                explosionSound.play();
-                screenShake.shake(4.f, 0.2f);
-                if (!hud.isAlive()) { gameOverScreen.reset(); currentState = GameState::GAME_OVER; }
-                it = asteroids.erase(it); continue;
-            }
-			// Player bullets vs Asteroids
-            for (auto bulletIt = playerBullets.begin(); bulletIt != playerBullets.end();) {
-				// Bullet hits asteroid
-                if (it->getGlobalBounds().findIntersection(bulletIt->getGlobalBounds())) {
-                    it->takeDamage(1);
-                    explosions.emplace_back(&explosionFrames, it->getPosition().x, it->getPosition().y);
-                    bulletIt = playerBullets.erase(bulletIt);
-                    screenShake.shake(4.f, 0.15f);
-                }
-				// No hit, move to next bullet
-                else ++bulletIt;
-            }
-			// Remove asteroid if destroyed or out of bounds
-            if (!it->isAlive) {
-				explosionSound.play();
-                hud.addScore(30);
-                explosions.emplace_back(&explosionFrames, it->getPosition().x, it->getPosition().y);
-                it = asteroids.erase(it);
-            }
-			//  Out of bounds
-            else if (it->getPosition().y > window.getSize().y) it = asteroids.erase(it);
-			// Continue to next asteroid
-            else ++it;
-        }
-
-        
-		// Boss spawning
-        if (hud.getScore() >= nextBossScore && !activeBoss) {
-            int bossHealth = 250 + (bossCount * 100);
-            float bossBulletSpeed = 300.f + (std::min(bossCount, 5) * 30.f);
-            activeBoss = new Boss(bossTex, bossHealth, bossBulletSpeed);
-        }
-		// Update Boss
-        if (activeBoss) {
-            activeBoss->update(dt, window.getSize(), enemyBullets, bulletTex);
-            for (auto it = playerBullets.begin(); it != playerBullets.end();) {
-				// Player bullet hits boss
-                if (activeBoss->getGlobalBounds().findIntersection(it->getGlobalBounds())) {
-                    activeBoss->takeDamage(10);
-                    bossHitSound.play();
-                    explosions.emplace_back(&explosionFrames, it->getPosition().x, it->getPosition().y);
-                    screenShake.shake(4.f, 0.1f);
-                    it = playerBullets.erase(it);
-					// Check if boss defeated
-                    if (!activeBoss->isAlive()) {
-                        hud.addScore(100); hud.addEnemyDefeated();
-                        explosions.emplace_back(&explosionFrames, activeBoss->getPosition().x, activeBoss->getPosition().y);
-                        screenShake.shake(12.5f, 0.5f);
-                        powerups.emplace_back(healTex, Powerup::HEAL, activeBoss->getPosition().x, activeBoss->getPosition().y);
-                        delete activeBoss; activeBoss = nullptr;
-                        bossCount++;
-                        nextBossScore += 600;
-                        break;
-                    }
-                } else ++it;
-            }
-			// Boss vs Player
-            if (activeBoss && activeBoss->getGlobalBounds().findIntersection(player->getGlobalBounds())) {
-                hud.loseHeart(); screenShake.shake(10.f, 0.2f);
-            }
-        }
-
-
-        // Player bullets vs enemies
-        for (size_t i = 0; i < playerBullets.size(); i++) {
-            playerBullets[i].update(dt);
-            bool removed = false;
-            for (size_t k = 0; k < enemies.size(); k++) {
-				// Bullet hits enemy
-                if (playerBullets[i].getGlobalBounds().findIntersection(enemies[k].getGlobalBounds())) {
-                    sf::Vector2f enemyPos = enemies[k].getPosition();
-                    enemies[k].takeDamage(10);
-                    explosions.emplace_back(&explosionFrames, enemyPos.x, enemyPos.y);
-                    playerBullets.erase(playerBullets.begin() + i); removed = true;
-					// Check if enemy destroyed
-                    if (enemies[k].getHp() <= 0) {
-                        explosionSound.play();
-                        hud.addScore(10); hud.addEnemyDefeated();
-						// 20% chance to drop powerup
-                        if (rand() % 2 == 0) {
-                            int typeId = rand() % 3;
-                            auto type = static_cast<Powerup::Type>(typeId);
-                            sf::Texture* tex = (type == Powerup::SCORE_BONUS) ? &coinTex : 
-                                              (type == Powerup::HEAL) ? &healTex : &boltTex;
-                            powerups.emplace_back(*tex, type, enemyPos.x, enemyPos.y);
-                        }
-						// Remove enemy
-                        enemies.erase(enemies.begin() + k);
-                        screenShake.shake(4.f, 0.2f);
-                    } 
-					// Bullet processed, exit enemy loop
-                    else {
-                        screenShake.shake(4.f, 0.1f);
-                    }
-                    break;
-                }
-            }
-			// Remove bullet if out of bounds
-            if (!removed && playerBullets[i].getGlobalBounds().position.y < 0) {
-                playerBullets.erase(playerBullets.begin() + i); i--;
-            } else if (removed) i--;
-        }
-
-        // Enemy bullets vs player
-        for (size_t i = 0; i < enemyBullets.size(); i++) {
-            enemyBullets[i].update(dt);
-			// Bullet hits player
-            if (enemyBullets[i].getGlobalBounds().findIntersection(player->getGlobalBounds())) {
-                sf::Vector2f playerPos = player->getPosition();
-                enemyBullets.erase(enemyBullets.begin() + i);
-                hud.loseHeart();
-                explosions.emplace_back(&playerExplosionFrames, playerPos.x, playerPos.y);
-				// Check if player is dead
-                if (!hud.isAlive()) {
-                    if (hud.getScore() > currentHighScore) { currentHighScore = hud.getScore(); saveHighScore(currentHighScore); }
-                    gameOverScreen.reset();
-                    currentState = GameState::GAME_OVER;
-                }
-                screenShake.shake(4.f, 0.10f);
-                i--;
-                continue;
-            }
-            // Remove bullet if out of bounds
-			else if (enemyBullets[i].getGlobalBounds().position.y > window.getSize().y) {
-                enemyBullets.erase(enemyBullets.begin() + i); i--;
-            }
-        }
-
-        // Update explosions
-        for (size_t i = 0; i < explosions.size(); i++) {
-            explosions[i].update(dt);
-            if (explosions[i].isFinished()) {
-                explosions.erase(explosions.begin() + i); i--;
-            }
-        }
-
-        // Powerups
-        for (size_t i = 0; i < powerups.size(); i++) {
-            powerups[i].update(dt);
-			// Check for collection by player
-            if (powerups[i].getGlobalBounds().findIntersection(player->getGlobalBounds())) {
-                switch (powerups[i].getType()) {
-                case Powerup::SCORE_BONUS: hud.addScore(50); hud.showPowerup("+50 SCORE!"); break;
-                case Powerup::HEAL: hud.heal(3); hud.showPowerup("+3 HEALTH!"); break;
-                case Powerup::TRIPLE_SHOT: player->activateTripleShot(10.f); hud.showPowerup("TRIPLE SHOT!");  break;
-                }
-                powerups.erase(powerups.begin() + i); i--;
-            }
-			// Remove if out of bounds
-            else if (powerups[i].getGlobalBounds().position.y > window.getSize().y) {
-                powerups.erase(powerups.begin() + i); i--;
-            }
-        }
-    }
-
-	// RENDER FUNCTION
-    void render() {
-        window.clear();
-		// game state menu
-        if (currentState == GameState::MENU) {
-            window.setView(window.getDefaultView());
-            menu.render(window);
-        }
-		// game state options
-        else if (currentState == GameState::OPTIONS) {
-            window.setView(window.getDefaultView());
-            optionsMenu.render(window);
-        }
-		// game state playing
-        else if (currentState == GameState::PLAYING) {
-			// Apply screen shake to view
-            sf::View view = window.getView();
-            view.setCenter({ 600.f + screenShake.getOffset().x, 450.f + screenShake.getOffset().y });
-            window.setView(view);
-
-			// Render game objects
-            background->render(window);
-            stars->render(window);
-            for (auto& b : playerBullets) b.render(window);
-            for (auto& b : enemyBullets) b.render(window);
-            for (auto& p : powerups) p.render(window);
-            for (auto& e : explosions) e.render(window);
-            for (auto& a : asteroids) a.render(window);
-            player->render(window);
-            if (activeBoss) activeBoss->render(window);
-            for (auto& e : enemies) e.render(window);
-            hud.render(window);
-            
-            pauseMenu.renderIcon(window);
-            if (pauseMenu.isPaused()) {
-                pauseMenu.renderMenu(window);
-            }
-        }
-		// game state high score
-        else if (currentState == GameState::HIGHSCORE) {
-            window.setView(window.getDefaultView());
-            window.draw(*highScoreSprite);
-			// Draw high score text
-            sf::Text scoreNum(hud.getFont(), std::to_string(currentHighScore), 100);
-            scoreNum.setFillColor(sf::Color::White);
-            scoreNum.setOutlineColor(sf::Color::Black);
-            scoreNum.setOutlineThickness(4.f);
-            sf::FloatRect scoreBounds = scoreNum.getLocalBounds();
-            scoreNum.setOrigin({ scoreBounds.size.x / 2.f, scoreBounds.size.y / 2.f });
-            scoreNum.setPosition({ 600.f, 450.f });
-            window.draw(scoreNum);
-            
-            sf::Text backText(hud.getFont(), "Press ESC", 30);
-            backText.setPosition({ 50.f, 850.f });
-            window.draw(backText);
-        }
-		// game state game over
-        else if (currentState == GameState::GAME_OVER) {
-            window.setView(window.getDefaultView());
-            background->render(window);
-            gameOverScreen.render(window);
-            hud.render(window);
-        }
-		// Display the rendered frame
-        window.display();
-    }
+#include <iostream>
+#pragma once
+
+#include <SFML/Graphics.hpp>
+#include <SFML/Audio.hpp>
+#include <SFML/Network.hpp>
+#include <SFML/OpenGL.hpp>
+#include <vector>
+#include <string>
+#include <iostream>
+#include <fstream>
+#include <cmath>
+#include <cstdlib>
+#include <ctime>
+#include <optional>
+#include <memory>
+#include <array>
+#include <unordered_map>
+#include <map>
+#include <set>
+#include <cstdint>
+#include <cstdio>
+#include <future>
+#include <algorithm>
+#include <chrono>
+#include <thread>
+#include <sstream>
+#include <iomanip>
+#include <cstring>
+#include <type_traits>
+#include <mutex>
+#include <condition_variable>
+#include <filesystem>
+#include <atomic>
+#ifdef _WIN32
+#include <io.h>
+#else
+#include <fcntl.h>
+#include <unistd.h>
+#endif
+
+#define M_PI 3.14159265358979323846
+
+// ============================================================================
+// GAME STATE ENUM
+// ============================================================================
+// Each state is a scene on Game's scene stack (see pushScene)
+enum class GameState {
+    MENU,
+    PLAYING,
+    GAME_OVER,
+    HIGHSCORE,
+	LOADING,
+	OPTIONS,
+    PAUSED      // Pause menu over PLAYING
+};
+
+// ============================================================================
+// RESOURCE CACHE
+// ============================================================================
+using TextureHandle = std::shared_ptr<const sf::Texture>;
+using SoundBufferHandle = std::shared_ptr<const sf::SoundBuffer>;
+using FontHandle = std::shared_ptr<const sf::Font>;
+
+// Files the game writes next to the executable. Co-op instances on one machine
+// add a per-port suffix (set before Game is constructed) so they never share one.
+struct SaveFiles {
+    static inline std::string suffix;
+	// "leaderboard.bin" -> "leaderboard-5000.bin"
+    static std::string path(const std::string& name) {
+        std::size_t dot = name.rfind('.');
+        return dot == std::string::npos ? name + suffix : name.substr(0, dot) + suffix + name.substr(dot);
+    }
+};
+
+// On-screen scale of each sprite type relative to its source art. Unless high
+// resolution art is requested, textures are resampled to this size at load
+// time and the sprites draw at scale 1.
+struct ArtScale {
+    static constexpr float enemy = 0.11f;
+    static constexpr float powerup = 0.04f;
+    static constexpr float boss = 0.20f;
+    static constexpr float asteroid = 0.8f;
+    static inline bool highResolution = false;
+	// Scale a sprite should be drawn at for a given art scale
+    static float draw(float artScale) { return highResolution ? artScale : 1.f; }
+};
+
+struct ResourceCache {
+	// Cached asset entry
+    struct Entry {
+        std::shared_ptr<const void> resource;
+        std::size_t bytes = 0;
+        const char* kind = "";
+        std::string source;          // File the asset was decoded from
+        std::uint64_t lastUsed = 0;  // LRU stamp
+    };
+    std::map<std::string, Entry> entries;
+    TextureHandle missingTexture = std::make_shared<const sf::Texture>();
+
+    // Scene residency: files only needed by one GameState, decoded ahead of time
+    // on a worker thread and evicted least-recently-used first once released
+    std::map<GameState, std::vector<std::string>> sceneAssets;
+    std::map<std::string, std::shared_future<sf::Image>> pendingImages;  // Counted against sceneBudget once decoded
+    std::set<std::string> failedPaths;  // Files that could not be decoded, never retried
+    std::size_t sceneBudget = 8 * 1024 * 1024;  // Resident bytes allowed for scene assets
+    std::uint64_t useCounter = 0;
+    bool mipmaps = true;  // Build mipmaps for high resolution art drawn scaled down
+
+	// Load a texture once per path, nullptr if the file cannot be loaded
+    TextureHandle tryTexture(const std::string& path) {
+        auto it = entries.find(path);
+        if (it != entries.end()) {
+            it->second.lastUsed = ++useCounter;
+            return std::static_pointer_cast<const sf::Texture>(it->second.resource);
+        }
+        sf::Image image;
+        if (!takeImage(path, image)) return nullptr;
+        auto tex = std::make_shared<sf::Texture>();
+        if (!tex->loadFromImage(image)) return nullptr;
+        return std::static_pointer_cast<const sf::Texture>(store(path, tex, textureBytes(*tex), "texture", path));
+    }
+	// Load a sprite sheet once and split it into cols x rows frame textures
+    std::vector<TextureHandle> sheetFrames(const std::string& path, int cols, int rows, sf::Color maskColor) {
+        std::vector<TextureHandle> frames;
+        for (int i = 0; i < cols * rows; i++) {
+            auto it = entries.find(path + "#" + std::to_string(i));
+            if (it == entries.end()) break;
+            it->second.lastUsed = ++useCounter;
+            frames.push_back(std::static_pointer_cast<const sf::Texture>(it->second.resource));
+        }
+        if (static_cast<int>(frames.size()) == cols * rows) return frames;
+        frames.clear();
+		// Decode (or collect the prefetched) sheet and slice it
+        sf::Image sheet;
+        if (!takeImage(path, sheet)) return frames;
+        sheet.createMaskFromColor(maskColor);
+        int fw = sheet.getSize().x / cols, fh = sheet.getSize().y / rows;
+        for (int y = 0; y < rows; y++) {
+            for (int x = 0; x < cols; x++) {
+                sf::Image tempImg; tempImg.resize({ static_cast<unsigned>(fw), static_cast<unsigned>(fh) });
+                tempImg.copy(sheet, { 0, 0 }, sf::IntRect({ x * fw, y * fh }, { fw, fh }));
+                auto tex = std::make_shared<sf::Texture>();
+                if (!tex->loadFromImage(tempImg)) continue;
+                std::string key = path + "#" + std::to_string(y * cols + x);
+                frames.push_back(std::static_pointer_cast<const sf::Texture>(store(key, tex, textureBytes(*tex), "texture", path)));
+            }
+        }
+        return frames;
+    }
+	// Load a texture, falling back to another handle (or an empty texture) on failure
+    TextureHandle texture(const std::string& path, const TextureHandle& fallback = nullptr) {
+        if (TextureHandle tex = tryTexture(path)) return tex;
+        return fallback ? fallback : missingTexture;
+    }
+	// Load a texture resampled to the size it is drawn at (see ArtScale)
+    TextureHandle scaledTexture(const std::string& path, float artScale, const TextureHandle& fallback = nullptr) {
+        if (artScale >= 1.f) return texture(path, fallback);
+        std::string key = path + "@" + std::to_string(artScale) + (ArtScale::highResolution ? "+mip" : "");
+        auto it = entries.find(key);
+        if (it != entries.end()) {
+            it->second.lastUsed = ++useCounter;
+            return std::static_pointer_cast<const sf::Texture>(it->second.resource);
+        }
+        sf::Image image;
+        if (!takeImage(path, image)) return fallback ? fallback : missingTexture;
+        auto tex = std::make_shared<sf::Texture>();
+        std::size_t bytes = 0;
+        if (ArtScale::highResolution) {
+			// Keep the original, mipmapped so the GPU minifies it cleanly
+            if (!tex->loadFromImage(image)) return fallback ? fallback : missingTexture;
+            tex->setSmooth(true);
+            bytes = textureBytes(*tex);
+            if (mipmaps && tex->generateMipmap()) bytes += bytes / 3;
+        } else {
+            sf::Vector2u size = image.getSize();
+            sf::Vector2u target = {
+                std::max(1u, static_cast<unsigned>(std::lround(size.x * artScale))),
+                std::max(1u, static_cast<unsigned>(std::lround(size.y * artScale)))
+            };
+            if (!tex->loadFromImage(resample(image, target))) return fallback ? fallback : missingTexture;
+            tex->setSmooth(true);
+            bytes = textureBytes(*tex);
+        }
+        return std::static_pointer_cast<const sf::Texture>(store(key, tex, bytes, "texture", path));
+    }
+	// Upload an in-memory image once per pixel content
+    TextureHandle textureFromImage(const sf::Image& image) {
+        std::string key = "image:" + hashImage(image);
+        auto it = entries.find(key);
+        if (it != entries.end()) {
+            it->second.lastUsed = ++useCounter;
+            return std::static_pointer_cast<const sf::Texture>(it->second.resource);
+        }
+        auto tex = std::make_shared<sf::Texture>();
+        if (!tex->loadFromImage(image)) return missingTexture;
+        return std::static_pointer_cast<const sf::Texture>(store(key, tex, textureBytes(*tex), "texture", key));
+    }
+	// Decode a sound buffer once per path
+    SoundBufferHandle soundBuffer(const std::string& path) {
+        auto it = entries.find(path);
+        if (it != entries.end()) return std::static_pointer_cast<const sf::SoundBuffer>(it->second.resource);
+        auto buffer = std::make_shared<sf::SoundBuffer>();
+        if (!buffer->loadFromFile(path)) std::cerr << "Failed to load sound: " << path << "\n";
+        std::size_t bytes = static_cast<std::size_t>(buffer->getSampleCount()) * sizeof(std::int16_t);
+        return std::static_pointer_cast<const sf::SoundBuffer>(store(path, buffer, bytes, "sound", path));
+    }
+	// Open a font once per path
+    FontHandle font(const std::string& path) {
+        auto it = entries.find(path);
+        if (it != entries.end()) return std::static_pointer_cast<const sf::Font>(it->second.resource);
+        auto f = std::make_shared<sf::Font>();
+        if (!f->openFromFile(path)) std::cerr << "Failed to load font: " << path << "\n";
+        return std::static_pointer_cast<const sf::Font>(store(path, f, 0, "font", path));
+    }
+
+	// Start decoding a file on a worker thread unless it is resident or already queued
+    void prefetch(const std::string& path) {
+        if (pendingImages.count(path) || failedPaths.count(path) || isResident(path)) return;
+        pendingImages[path] = std::async(std::launch::async, [path]() {
+            sf::Image image;
+            if (!image.loadFromFile(path)) return sf::Image();
+            return image;
+        }).share();
+    }
+	// Prefetch every file a state is about to need
+    void prefetchScene(GameState state) {
+        auto group = sceneAssets.find(state);
+        if (group == sceneAssets.end()) return;
+        for (const auto& path : group->second) prefetch(path);
+    }
+	// Evict released scene assets, least recently used first, until within budget
+    void trim(GameState activeState) {
+		// Prefetches for a scene that was not entered are stale; drop them once decoded
+        std::size_t sceneBytes = 0;
+        for (auto it = pendingImages.begin(); it != pendingImages.end();) {
+            if (!isReady(it->second)) { ++it; continue; }
+            if (!isSceneAsset(it->first, activeState)) { it = pendingImages.erase(it); continue; }
+            sceneBytes += imageBytes(it->second.get());
+            ++it;
+        }
+        std::vector<std::map<std::string, Entry>::iterator> candidates;
+        for (auto it = entries.begin(); it != entries.end(); ++it) {
+            if (!isSceneAsset(it->second.source)) continue;
+            sceneBytes += it->second.bytes;
+            // Only entries nobody else holds free memory when dropped
+            if (it->second.resource.use_count() == 1 && !isSceneAsset(it->second.source, activeState))
+                candidates.push_back(it);
+        }
+        std::sort(candidates.begin(), candidates.end(),
+            [](const auto& a, const auto& b) { return a->second.lastUsed < b->second.lastUsed; });
+        for (auto it : candidates) {
+            if (sceneBytes <= sceneBudget) break;
+            sceneBytes -= it->second.bytes;
+            entries.erase(it);
+        }
+    }
+
+	// Memory accounting
+    std::size_t residentBytes() const {
+        std::size_t total = 0;
+        for (const auto& [key, entry] : entries) total += entry.bytes;
+        return total;
+    }
+	// Print resident memory and live handle count per asset
+    void printReport(std::ostream& out) const {
+        for (const auto& [key, entry] : entries) {
+            out << entry.kind << "  " << key << "  " << (entry.bytes / 1024) << " KiB  refs="
+                << (entry.resource.use_count() - 1) << (isSceneAsset(entry.source) ? "  (scene)" : "") << "\n";
+        }
+        out << "Total resident: " << (residentBytes() / 1024) << " KiB in " << entries.size() << " assets\n";
+    }
+
+	// Helpers
+    std::shared_ptr<const void> store(const std::string& key, std::shared_ptr<const void> resource, std::size_t bytes, const char* kind, const std::string& source) {
+        entries[key] = Entry{ resource, bytes, kind, source, ++useCounter };
+        return resource;
+    }
+	// Take a prefetched image if one is queued, otherwise decode it now
+    bool takeImage(const std::string& path, sf::Image& image) {
+        bool loaded = false;
+        auto pending = pendingImages.find(path);
+        if (pending != pendingImages.end()) {
+            image = pending->second.get();
+            pendingImages.erase(pending);
+            loaded = image.getSize().x > 0;
+        }
+        else if (!failedPaths.count(path)) {
+            loaded = image.loadFromFile(path);
+        }
+        if (!loaded) failedPaths.insert(path);
+        return loaded;
+    }
+    bool isResident(const std::string& source) const {
+        for (const auto& [key, entry] : entries) if (entry.source == source) return true;
+        return false;
+    }
+	// Whether a file belongs to any scene group (or to a specific state's group)
+    bool isSceneAsset(const std::string& source) const {
+        for (const auto& [state, paths] : sceneAssets)
+            if (std::find(paths.begin(), paths.end(), source) != paths.end()) return true;
+        return false;
+    }
+    bool isSceneAsset(const std::string& source, GameState state) const {
+        auto group = sceneAssets.find(state);
+        return group != sceneAssets.end() && std::find(group->second.begin(), group->second.end(), source) != group->second.end();
+    }
+    static bool isReady(const std::shared_future<sf::Image>& pending) {
+        return pending.wait_for(std::chrono::seconds(0)) == std::future_status::ready;
+    }
+    static std::size_t imageBytes(const sf::Image& image) {
+        return static_cast<std::size_t>(image.getSize().x) * image.getSize().y * 4;
+    }
+    static std::size_t textureBytes(const sf::Texture& tex) {
+        return static_cast<std::size_t>(tex.getSize().x) * tex.getSize().y * 4;
+    }
+	// Area-averaging downscale (separable box filter over premultiplied alpha)
+    static sf::Image resample(const sf::Image& src, sf::Vector2u dstSize) {
+        sf::Vector2u srcSize = src.getSize();
+        const std::uint8_t* in = src.getPixelsPtr();
+		// Average a run of source samples covering [start, start + step)
+        auto filter = [](const std::vector<float>& from, std::vector<float>& to, unsigned srcLen, unsigned dstLen,
+                         unsigned lines, std::size_t pixelStride, std::size_t lineStride) {
+            float step = static_cast<float>(srcLen) / static_cast<float>(dstLen);
+            for (unsigned line = 0; line < lines; line++) {
+                for (unsigned d = 0; d < dstLen; d++) {
+                    float start = d * step, end = start + step;
+                    float sum[4] = { 0.f, 0.f, 0.f, 0.f };
+                    for (unsigned i = static_cast<unsigned>(start); i < srcLen && i < end; i++) {
+                        float weight = std::min(end, i + 1.f) - std::max(start, static_cast<float>(i));
+                        const float* px = &from[(line * lineStride + i * pixelStride) * 4];
+                        for (int c = 0; c < 4; c++) sum[c] += px[c] * weight;
+                    }
+                    float* out = &to[(line * lineStride + d * pixelStride) * 4];
+                    for (int c = 0; c < 4; c++) out[c] = sum[c] / step;
+                }
+            }
+        };
+		// Premultiply so transparent texels do not bleed dark fringes
+        std::vector<float> source(static_cast<std::size_t>(srcSize.x) * srcSize.y * 4);
+        for (std::size_t i = 0; i < source.size(); i += 4) {
+            float alpha = in[i + 3] / 255.f;
+            source[i] = in[i] * alpha; source[i + 1] = in[i + 1] * alpha; source[i + 2] = in[i + 2] * alpha; source[i + 3] = in[i + 3];
+        }
+		// Horizontal pass keeps the source row stride, vertical pass walks columns
+        std::vector<float> horizontal(source.size());
+        filter(source, horizontal, srcSize.x, dstSize.x, srcSize.y, 1, srcSize.x);
+        std::vector<float> vertical(source.size());
+        filter(horizontal, vertical, srcSize.y, dstSize.y, dstSize.x, srcSize.x, 1);
+		// Un-premultiply into the destination image
+        sf::Image result({ dstSize.x, dstSize.y }, sf::Color::Transparent);
+        for (unsigned y = 0; y < dstSize.y; y++) {
+            for (unsigned x = 0; x < dstSize.x; x++) {
+                const float* px = &vertical[(static_cast<std::size_t>(y) * srcSize.x + x) * 4];
+                float alpha = px[3];
+                float inv = alpha > 0.f ? 255.f / alpha : 0.f;
+                auto channel = [](float v) { return static_cast<std::uint8_t>(std::min(255.f, std::max(0.f, v + 0.5f))); };
+                result.setPixel({ x, y }, sf::Color(channel(px[0] * inv), channel(px[1] * inv), channel(px[2] * inv), channel(alpha)));
+            }
+        }
+        return result;
+    }
+	// FNV-1a hash of image size and pixels
+    static std::string hashImage(const sf::Image& image) {
+        std::uint64_t hash = 14695981039346656037ull;
+        auto mix = [&hash](std::uint8_t byte) { hash ^= byte; hash *= 1099511628211ull; };
+        sf::Vector2u size = image.getSize();
+        for (int i = 0; i < 4; i++) { mix(static_cast<std::uint8_t>(size.x >> (i * 8))); mix(static_cast<std::uint8_t>(size.y >> (i * 8))); }
+        const std::uint8_t* pixels = image.getPixelsPtr();
+        std::size_t count = static_cast<std::size_t>(size.x) * size.y * 4;
+        for (std::size_t i = 0; i < count; i++) mix(pixels[i]);
+        char buf[17];
+        std::snprintf(buf, sizeof(buf), "%016llx", static_cast<unsigned long long>(hash));
+        return buf;
+    }
+};
+
+// ============================================================================
+// BULLET PATTERNS
+// ============================================================================
+// Direction and sprite rotation of one bullet in a pattern
+struct PatternShot {
+    float dirX = 0.f, dirY = 1.f;
+    float rotationDeg = 180.f;
+};
+
+// Runtime view of a compile-time pattern: volleys of shots fired one volley
+// per attack. Aimed patterns hold one volley per heading instead and the
+// heading closest to the target is fired.
+struct PatternRef {
+    const PatternShot* shots = nullptr;
+    int shotsPerVolley = 0;
+    int volleys = 0;
+    bool aimed = false;
+    float speedScale = 1.f;
+};
+
+namespace BulletPatterns {
+    constexpr double pi = 3.14159265358979323846;
+    constexpr int aimHeadings = 64;
+
+	// constexpr trigonometry (Taylor series after range reduction)
+    constexpr double sinDeg(double deg) {
+        double x = deg * pi / 180.0;
+        while (x > pi) x -= 2.0 * pi;
+        while (x < -pi) x += 2.0 * pi;
+        double term = x, sum = x;
+        for (int i = 1; i < 12; i++) {
+            term *= -x * x / ((2.0 * i) * (2.0 * i + 1.0));
+            sum += term;
+        }
+        return sum;
+    }
+    constexpr double cosDeg(double deg) { return sinDeg(deg + 90.0); }
+
+	// Shot at angleDeg from straight down, positive towards +x
+    constexpr PatternShot shotAt(double angleDeg) {
+        return { static_cast<float>(sinDeg(angleDeg)), static_cast<float>(cosDeg(angleDeg)), static_cast<float>(180.0 - angleDeg) };
+    }
+
+    template <std::size_t Count>
+    struct Pattern {
+        std::array<PatternShot, Count> shots{};
+        int shotsPerVolley = 0;
+        int volleys = 0;
+        bool aimed = false;
+    };
+
+	// N shots spread evenly around the full circle
+    template <int N>
+    constexpr Pattern<N> ring(double offsetDeg = 0.0) {
+        Pattern<N> p;
+        for (int i = 0; i < N; i++) p.shots[i] = shotAt(offsetDeg + 360.0 * i / N);
+        p.shotsPerVolley = N; p.volleys = 1;
+        return p;
+    }
+	// N shots fanned across spreadDeg, centred on centerDeg
+    template <int N>
+    constexpr Pattern<N> fan(double spreadDeg, double centerDeg = 0.0) {
+        Pattern<N> p;
+        for (int i = 0; i < N; i++) p.shots[i] = shotAt(centerDeg + (N > 1 ? spreadDeg * i / (N - 1) - spreadDeg / 2.0 : 0.0));
+        p.shotsPerVolley = N; p.volleys = 1;
+        return p;
+    }
+	// Arms rotating by stepDeg every volley
+    template <int Arms, int Volleys>
+    constexpr Pattern<Arms * Volleys> spiral(double stepDeg) {
+        Pattern<Arms * Volleys> p;
+        for (int v = 0; v < Volleys; v++)
+            for (int a = 0; a < Arms; a++) p.shots[v * Arms + a] = shotAt(stepDeg * v + 360.0 * a / Arms);
+        p.shotsPerVolley = Arms; p.volleys = Volleys;
+        return p;
+    }
+	// Fan whose centre sways left and right over the volleys
+    template <int N, int Volleys>
+    constexpr Pattern<N * Volleys> wave(double spreadDeg, double swayDeg) {
+        Pattern<N * Volleys> p;
+        for (int v = 0; v < Volleys; v++) {
+            double center = swayDeg * sinDeg(360.0 * v / Volleys);
+            for (int i = 0; i < N; i++) p.shots[v * N + i] = shotAt(center + (N > 1 ? spreadDeg * i / (N - 1) - spreadDeg / 2.0 : 0.0));
+        }
+        p.shotsPerVolley = N; p.volleys = Volleys;
+        return p;
+    }
+	// Fan pre-rotated towards each of aimHeadings directions
+    template <int N>
+    constexpr Pattern<N * aimHeadings> aimedFan(double spreadDeg) {
+        Pattern<N * aimHeadings> p;
+        for (int h = 0; h < aimHeadings; h++) {
+            double heading = 360.0 * h / aimHeadings;
+            for (int i = 0; i < N; i++) p.shots[h * N + i] = shotAt(heading + (N > 1 ? spreadDeg * i / (N - 1) - spreadDeg / 2.0 : 0.0));
+        }
+        p.shotsPerVolley = N; p.volleys = aimHeadings; p.aimed = true;
+        return p;
+    }
+
+    template <std::size_t Count>
+    constexpr PatternRef ref(const Pattern<Count>& p, float speedScale = 1.f) {
+        return { p.shots.data(), p.shotsPerVolley, p.volleys, p.aimed, speedScale };
+    }
+
+	// Pattern library
+    inline constexpr PatternShot straightDown = shotAt(0.0);
+    inline constexpr auto singleDown = fan<1>(0.0);
+    inline constexpr auto headings = ring<aimHeadings>();
+    inline constexpr auto classicSpread = fan<3>(50.0);
+    inline constexpr auto swayingWave = wave<5, 8>(60.0, 20.0);
+    inline constexpr auto aimedTriple = aimedFan<3>(30.0);
+    inline constexpr auto aimedSingle = aimedFan<1>(0.0);
+    inline constexpr auto fourArmSpiral = spiral<4, 12>(7.5);
+    inline constexpr auto burstRing = ring<12>(15.0);
+
+	// Player triple shot offset (+/-15 degrees)
+    inline constexpr float tripleShotCos = static_cast<float>(cosDeg(15.0));
+    inline constexpr float tripleShotSin = static_cast<float>(sinDeg(15.0));
+}
+
+// Boss attack phase, active once HP falls to hpFraction of max
+struct BossPhase {
+    float hpFraction;
+    float attackScale;  // Multiplier on Boss::attackMax
+    PatternRef patterns[2];
+};
+
+inline constexpr BossPhase bossPhases[] = {
+    { 1.00f, 1.0f, { BulletPatterns::ref(BulletPatterns::classicSpread), {} } },
+    { 0.66f, 0.9f, { BulletPatterns::ref(BulletPatterns::swayingWave), BulletPatterns::ref(BulletPatterns::aimedTriple, 1.2f) } },
+    { 0.33f, 0.3f, { BulletPatterns::ref(BulletPatterns::fourArmSpiral, 0.8f), BulletPatterns::ref(BulletPatterns::aimedSingle, 1.3f) } },
+    { 0.10f, 0.8f, { BulletPatterns::ref(BulletPatterns::burstRing, 0.9f), BulletPatterns::ref(BulletPatterns::aimedTriple, 1.2f) } },
+};
+
+// ============================================================================
+// PLAYFIELD
+// ============================================================================
+// Lifetime and culling rules shared by every entity container: an entity lives
+// while its bounds touch the playfield grown by a margin (room to spawn above
+// the top edge), and is drawn only while it touches the visible area.
+struct Playfield {
+    static constexpr float width = 1200.f, height = 900.f;
+    static constexpr float lifeMargin = 100.f;  // Spawns happen at y = -50
+    static constexpr float viewMargin = 16.f;   // Covers screen shake offsets
+
+    static bool touches(const sf::FloatRect& bounds, float margin) {
+        return bounds.position.x + bounds.size.x >= -margin && bounds.position.x <= width + margin
+            && bounds.position.y + bounds.size.y >= -margin && bounds.position.y <= height + margin;
+    }
+	// Still alive by position
+    static bool contains(const sf::FloatRect& bounds) { return touches(bounds, lifeMargin); }
+	// Worth drawing
+    static bool visible(const sf::FloatRect& bounds) { return touches(bounds, viewMargin); }
+	// Simulation bounds, independent of the window (there may be none)
+    static sf::Vector2u size() { return { static_cast<unsigned>(width), static_cast<unsigned>(height) }; }
+};
+
+// ============================================================================
+// BULLET
+// ============================================================================
+struct Bullet {
+	// Bullet sprite and direction
+    sf::Sprite sprite;
+    sf::Vector2f direction;
+    float speed = 500.f;
+    float timeToLive = 8.f;  // Backstop for bullets that never leave the playfield
+	// Constructor
+    Bullet(const sf::Texture& texture, float x, float y, float dirX, float dirY, float rotationDeg)
+        : sprite(texture), direction(dirX, dirY)
+    {
+        sprite.setPosition({ x, y });
+        sprite.setScale({ 1.5f, 1.5f });
+        sprite.setRotation(sf::degrees(rotationDeg));
+    }
+    Bullet(const sf::Texture& texture, float x, float y, const PatternShot& shot)
+        : Bullet(texture, x, y, shot.dirX, shot.dirY, shot.rotationDeg) {}
+	// Get bullet bounds and position
+    sf::FloatRect getGlobalBounds() const { return sprite.getGlobalBounds(); }
+    const sf::Vector2f& getPosition() const { return sprite.getPosition(); }
+	// Update bullet position
+    void update(sf::Time dt) {
+        sprite.move(direction * speed * dt.asSeconds());
+        timeToLive -= dt.asSeconds();
+    }
+	// Left the playfield or outlived its TTL
+    bool isExpired() const { return timeToLive <= 0.f || !Playfield::contains(getGlobalBounds()); }
+	// Render bullet
+    void render(sf::RenderTarget& target) {
+        target.draw(sprite);
+    }
+};
+
+// ============================================================================
+// MISSILE
+// ============================================================================
+// Homing missile: flies along its heading and turns toward a target point at a
+// limited rate. The target is looked up again every frame, so a missile never
+// holds on to an entity that has already been destroyed.
+struct Missile {
+    sf::Sprite sprite;
+    sf::Vector2f direction;
+    float speed = 420.f;
+    float turnRate = 5.f;      // Radians per second
+    float timeToLive = 3.f;
+    static constexpr float seekRange = 500.f, hitRadius = 8.f;
+    static constexpr int damage = 20;
+	// Constructor
+    Missile(const sf::Texture& texture, float x, float y, float dirX, float dirY)
+        : sprite(texture), direction(dirX, dirY)
+    {
+        sf::FloatRect bounds = sprite.getLocalBounds();
+        sprite.setOrigin({ bounds.size.x / 2.f, bounds.size.y / 2.f });
+        sprite.setPosition({ x, y });
+        sprite.setScale({ 1.5f, 1.5f });
+        sprite.setColor(sf::Color(255, 160, 60));
+        sprite.setRotation(sf::radians(std::atan2(dirX, -dirY)));
+    }
+	// Get missile bounds and position
+    sf::FloatRect getGlobalBounds() const { return sprite.getGlobalBounds(); }
+    const sf::Vector2f& getPosition() const { return sprite.getPosition(); }
+	// Turn toward the target (if any), then move
+    void update(sf::Time dt, const sf::Vector2f* target) {
+        float seconds = dt.asSeconds();
+        if (target) {
+            sf::Vector2f toTarget = *target - getPosition();
+            float cross = direction.x * toTarget.y - direction.y * toTarget.x;
+            float dot = direction.x * toTarget.x + direction.y * toTarget.y;
+            float maxTurn = turnRate * seconds;
+            float turn = std::max(-maxTurn, std::min(std::atan2(cross, dot), maxTurn));
+            float c = std::cos(turn), s = std::sin(turn);
+            direction = { direction.x * c - direction.y * s, direction.x * s + direction.y * c };
+            sprite.setRotation(sf::radians(std::atan2(direction.x, -direction.y)));
+        }
+        sprite.move(direction * speed * seconds);
+        timeToLive -= seconds;
+    }
+	// Left the playfield or burned out
+    bool isExpired() const { return timeToLive <= 0.f || !Playfield::contains(getGlobalBounds()); }
+	// Render missile
+    void render(sf::RenderTarget& target) { target.draw(sprite); }
+};
+
+// ============================================================================
+// ANIMATION CLIPS
+// ============================================================================
+// Frames are described once per clip as a texture rect and a duration. An
+// animated instance keeps only a clip id and the time it started; the frame to
+// draw is looked up from the elapsed time when it is rendered, so there is no
+// per-instance timer to step.
+struct AnimationFrame {
+    TextureHandle texture;
+    sf::IntRect rect;
+    float duration;
+};
+
+struct AnimationClip {
+    std::vector<AnimationFrame> frames;
+    std::vector<float> frameEnds;  // Time at which each frame ends
+    bool loop = false;
+	// Total length of one pass through the clip
+    float length() const { return frameEnds.empty() ? 0.f : frameEnds.back(); }
+    bool empty() const { return frames.empty(); }
+    bool isFinished(float elapsed) const { return !loop && elapsed >= length(); }
+	// Frame shown at a time since the clip started (the last one once finished)
+    int frameAt(float elapsed) const {
+        if (frames.empty()) return -1;
+        if (loop && length() > 0.f) elapsed = std::fmod(std::max(elapsed, 0.f), length());
+        int frame = static_cast<int>(std::upper_bound(frameEnds.begin(), frameEnds.end(), elapsed) - frameEnds.begin());
+        return std::min(frame, static_cast<int>(frames.size()) - 1);
+    }
+	// Point a sprite at a frame; the texture is only rebound when it changes
+    void applyFrame(sf::Sprite& sprite, int frame) const {
+        if (frame < 0 || frame >= static_cast<int>(frames.size())) return;
+        const AnimationFrame& f = frames[frame];
+        if (&sprite.getTexture() != f.texture.get()) sprite.setTexture(*f.texture);
+        sprite.setTextureRect(f.rect);
+    }
+    void apply(sf::Sprite& sprite, float elapsed) const { applyFrame(sprite, frameAt(elapsed)); }
+};
+
+struct AnimationLibrary {
+	// Clip ids (stored by instances and in snapshots)
+    enum Id { EXPLOSION = 0, PLAYER_EXPLOSION = 1, GAME_OVER = 2, PLAYER_BANK = 3, CLIP_COUNT };
+    AnimationClip clips[CLIP_COUNT];
+	// Build a clip from whole textures shown for an equal time each
+    void define(Id id, const std::vector<TextureHandle>& textures, float frameDuration, bool loop = false) {
+        AnimationClip& clip = clips[id];
+        release(id);
+        clip.loop = loop;
+        clip.frames.reserve(textures.size()); clip.frameEnds.reserve(textures.size());
+        for (const TextureHandle& tex : textures) {
+            if (!tex) continue;
+            clip.frames.push_back({ tex, sf::IntRect({ 0, 0 }, sf::Vector2i(tex->getSize())), frameDuration });
+            clip.frameEnds.push_back(clip.length() + frameDuration);
+        }
+    }
+	// Drop a clip's texture references so the cache can evict them
+    void release(Id id) {
+        clips[id].frames.clear();
+        clips[id].frameEnds.clear();
+    }
+    const AnimationClip& operator[](int id) const { return clips[std::max(0, std::min(id, CLIP_COUNT - 1))]; }
+};
+
+// ============================================================================
+// EXPLOSION
+// ============================================================================
+struct Explosion {
+	// Clip and the run time it started at
+    sf::Sprite sprite;
+    int clip;
+    float startTime;
+    float strength = 1.f;   // Grows as nearby impacts merge into it
+    int priority = 0;       // ImpactEffects::Priority of the most important impact
+	// Constructor (the clip must not be empty)
+    Explosion(const AnimationLibrary& animations, int clipId, float x, float y, float start)
+        : sprite(*animations[clipId].frames[0].texture), clip(clipId), startTime(start)
+    {
+        sf::FloatRect bounds = sprite.getLocalBounds();
+        sprite.setOrigin({ bounds.size.x / 2.0f, bounds.size.y / 1.5f });
+        sprite.setPosition({ x, y });
+        sprite.setScale({ 2.f, 2.f });
+    }
+	// Scale with strength
+    void setStrength(float s) {
+        strength = s;
+        sprite.setScale({ 2.f * s, 2.f * s });
+    }
+	// Render the frame for the current run time
+    void render(sf::RenderTarget& target, const AnimationLibrary& animations, float now) {
+        const AnimationClip& c = animations[clip];
+        if (c.isFinished(now - startTime)) return;
+        c.apply(sprite, now - startTime);
+        target.draw(sprite);
+    }
+	// Check if explosion animation is finished
+    bool isFinished(const AnimationLibrary& animations, float now) const { return animations[clip].isFinished(now - startTime); }
+};
+
+// ============================================================================
+// POWERUP
+// ============================================================================
+struct Powerup {
+	// Powerup types
+    enum Type { SCORE_BONUS = 0, HEAL = 1, TRIPLE_SHOT = 2, HOMING_MISSILES = 3, SMART_BOMB = 4 };
+	// Powerup sprite and type
+    sf::Sprite sprite;
+    Type type;
+    float speed = 100.f;
+	// Constructor
+    Powerup(const sf::Texture& texture, Type t, float x, float y)
+        : sprite(texture), type(t)
+    {
+        sprite.setPosition({ x, y });
+        sprite.setScale({ ArtScale::draw(ArtScale::powerup), ArtScale::draw(ArtScale::powerup) });
+        sf::FloatRect bounds = sprite.getLocalBounds();
+        sprite.setOrigin({ bounds.size.x / 2.f, bounds.size.y / 2.f });
+        // The newer powerups reuse existing art, tinted
+        if (t == HOMING_MISSILES) sprite.setColor(sf::Color(255, 160, 60));
+        else if (t == SMART_BOMB) sprite.setColor(sf::Color(255, 80, 80));
+    }
+	// Update powerup position
+    void update(sf::Time dt) {
+        sprite.move({ 0.f, speed * dt.asSeconds() });
+    }
+	// Render powerup
+    void render(sf::RenderTarget& target) { target.draw(sprite); }
+    sf::FloatRect getGlobalBounds() const { return sprite.getGlobalBounds(); }
+    Type getType() const { return type; }
+};
+
+// ============================================================================
+// ASTEROID
+// ============================================================================
+struct Asteroid {
+    sf::Sprite sprite;
+	// Asteroid attributes
+    float speed = 20.f;
+    float rotationSpeed = 45.f;
+    int health = 15;
+    bool isAlive = true;
+	// Constructor
+    Asteroid(const sf::Texture& texture, float startX, float startY)
+        : sprite(texture)
+    {
+        sprite.setPosition({ startX, startY });
+        sprite.setScale({ ArtScale::draw(ArtScale::asteroid), ArtScale::draw(ArtScale::asteroid) });
+        sf::FloatRect bounds = sprite.getLocalBounds();
+        sprite.setOrigin({ bounds.size.x / 2.f, bounds.size.y / 2.f });
+    }
+	// Get asteroid bounds and position
+    sf::FloatRect getGlobalBounds() const { return sprite.getGlobalBounds(); }
+    const sf::Vector2f& getPosition() const { return sprite.getPosition(); }
+	// Damage asteroid
+    void takeDamage(int damage) {
+        health -= damage;
+        if (health <= 0) isAlive = false;
+    }
+	// Update asteroid position and rotation
+    void update(sf::Time dt) {
+        if (!isAlive) return;
+        float newY = sprite.getPosition().y + (speed * dt.asSeconds());
+        sprite.setPosition({ sprite.getPosition().x, newY });
+        sprite.rotate(sf::degrees(rotationSpeed * dt.asSeconds()));
+    }
+	// Render asteroid
+    void render(sf::RenderTarget& target) {
+        if (isAlive) target.draw(sprite);
+    }
+};
+
+// ============================================================================
+// TIMER WHEEL
+// ============================================================================
+// Gameplay cooldowns and timed effects, kept off the per-frame path. Time runs
+// in fixed ticks and a pending timer sits in one slot of a hierarchical wheel:
+// four levels of 64 slots, each level 64 times coarser than the one below. A
+// timer is only touched again when its slot comes due or its coarse slot is
+// cascaded into a finer level, so scheduling and cancelling are O(1) list
+// operations and a tick costs nothing for timers that are not yet due. Timers
+// carry an event and two ints instead of a callback, so the pending set is
+// plain data that can go into a snapshot. Every enemy's next shot is one of
+// them, so a frame only touches the enemies that fire in it.
+struct TimerWheel {
+    static constexpr int slotBits = 6, slots = 1 << slotBits, levels = 4;
+    static constexpr float tickSeconds = 1.f / 120.f;
+    static constexpr std::uint32_t maxDelayTicks = (1u << (slotBits * levels)) - 1;  // ~39 hours
+	// What the game does when a timer fires
+    enum Event : std::int32_t {
+        NONE = 0, ENEMY_SPAWN, SWARM_WAVE, ASTEROID_SPAWN, TELEMETRY_SAMPLE, BOSS_ATTACK,
+        ATTACK_READY, TRIPLE_SHOT_END, HOMING_END, ENEMY_FIRE
+    };
+	// Generation-checked reference to a timer, safe to keep after it has fired
+    struct Handle {
+        std::int32_t index = -1;
+        std::uint32_t generation = 0;
+        bool empty() const { return index < 0; }
+    };
+    struct Timer {
+        std::uint32_t due = 0, generation = 0;
+        std::int32_t slot = -1, prev = -1, next = -1;  // Slot list links; slot is -1 while free
+        Event event = NONE;
+        std::int32_t a = 0, b = 0;
+    };
+    struct Fired { Event event; std::int32_t a, b; };
+
+    std::vector<Timer> pool;
+    std::vector<std::int32_t> freeList;
+    std::int32_t heads[levels * slots];
+    std::uint32_t tick = 0;      // Ticks elapsed
+    float remainder = 0.f;       // Seconds accumulated toward the next tick
+    std::vector<Fired> fired;    // Events that came due in the last advance
+
+	// Constructor
+    TimerWheel() { clear(); }
+	// Preallocate so scheduling during play never grows the pool
+    void reserve(std::size_t n) { pool.reserve(n); freeList.reserve(n); fired.reserve(n); }
+	// Drop every pending timer and restart the clock; held handles go stale
+    void clear() {
+        for (Timer& t : pool) if (t.slot >= 0) { t.slot = -1; t.generation++; }
+        tick = 0; remainder = 0.f;
+        fired.clear();
+        relink();
+    }
+	// Schedule an event some seconds from now (at least one tick)
+    Handle schedule(float delaySeconds, Event event, std::int32_t a = 0, std::int32_t b = 0) {
+        std::int32_t index;
+        if (!freeList.empty()) { index = freeList.back(); freeList.pop_back(); }
+        else { index = static_cast<std::int32_t>(pool.size()); pool.emplace_back(); }
+        float ticks = std::ceil((remainder + delaySeconds) / tickSeconds);
+        Timer& t = pool[index];
+        t.due = tick + static_cast<std::uint32_t>(std::max(1.f, std::min(ticks, static_cast<float>(maxDelayTicks))));
+        t.event = event; t.a = a; t.b = b;
+        link(index);
+        return { index, t.generation };
+    }
+	// Cancel a pending timer and empty the handle; stale handles are ignored
+    void cancel(Handle& handle) {
+        if (isPending(handle)) { unlink(handle.index); release(handle.index); }
+        handle = Handle();
+    }
+    bool isPending(const Handle& handle) const {
+        return handle.index >= 0 && handle.index < static_cast<std::int32_t>(pool.size())
+            && pool[handle.index].generation == handle.generation && pool[handle.index].slot >= 0;
+    }
+	// Seconds until a pending timer fires (0 once it has)
+    float remaining(const Handle& handle) const {
+        return isPending(handle) ? (pool[handle.index].due - tick) * tickSeconds - remainder : 0.f;
+    }
+	// Advance the clock and collect the events of every timer that came due, in tick order
+    const std::vector<Fired>& advance(float seconds) {
+        fired.clear();
+        remainder += seconds;
+        while (remainder >= tickSeconds) {
+            remainder -= tickSeconds;
+            step();
+        }
+        return fired;
+    }
+	// Rebuild slot lists and the free list after pool entries were written directly (snapshot restore)
+    void relink() {
+        std::fill(std::begin(heads), std::end(heads), -1);
+        freeList.clear();
+        for (std::int32_t i = static_cast<std::int32_t>(pool.size()) - 1; i >= 0; i--) {
+            if (pool[i].slot >= 0) link(i);
+            else freeList.push_back(i);
+        }
+    }
+
+private:
+	// One tick: on each wrap of a level, move the next coarser slot down, then fire the due slot
+    void step() {
+        tick++;
+        for (int level = 1; level < levels; level++) {
+            if ((tick & ((1u << (slotBits * level)) - 1)) != 0) break;
+            std::int32_t& head = heads[level * slots + ((tick >> (slotBits * level)) & (slots - 1))];
+            std::int32_t index = head;
+            head = -1;
+            while (index >= 0) {
+                std::int32_t next = pool[index].next;
+                link(index);
+                index = next;
+            }
+        }
+        std::int32_t& head = heads[tick & (slots - 1)];
+        while (head >= 0) {
+            std::int32_t index = head;
+            unlink(index);
+            fired.push_back({ pool[index].event, pool[index].a, pool[index].b });
+            release(index);
+        }
+    }
+	// Put a timer in the finest level whose span covers its delay
+    void link(std::int32_t index) {
+        Timer& t = pool[index];
+        std::uint32_t delta = t.due - tick;
+        int level = 0;
+        while (level < levels - 1 && delta >= (1u << (slotBits * (level + 1)))) level++;
+        t.slot = level * slots + static_cast<std::int32_t>((t.due >> (slotBits * level)) & (slots - 1));
+        t.prev = -1;
+        t.next = heads[t.slot];
+        if (t.next >= 0) pool[t.next].prev = index;
+        heads[t.slot] = index;
+    }
+    void unlink(std::int32_t index) {
+        Timer& t = pool[index];
+        if (t.prev >= 0) pool[t.prev].next = t.next;
+        else heads[t.slot] = t.next;
+        if (t.next >= 0) pool[t.next].prev = t.prev;
+    }
+    void release(std::int32_t index) {
+        pool[index].slot = -1;
+        pool[index].generation++;
+        freeList.push_back(index);
+    }
+};
+
+// ============================================================================
+// ENEMY
+// ============================================================================
+struct Enemy {
+	// Enemy sprite
+    sf::Sprite sprite;
+	// Enemy attributes
+    float speed = 50.f;
+    int hp = 70;
+    float startX;
+    float sineTimer = 0.f;
+    float shootCooldown;      // Seconds between sweeper shots
+    float halfWidth;  // Half the on-screen width, fixed per texture
+    std::int32_t id = 0;      // Unique in a run; ENEMY_FIRE timers name their enemy by it
+    TimerWheel::Handle shot;  // Pending ENEMY_FIRE timer
+    int behaviour = -1;       // Behaviour program index, -1 for the built-in sweep
+    std::uint32_t pc = 0;     // Current instruction
+    float opTimer = 0.f;      // Time spent in the current instruction
+    int autofireOp = -1;      // Instruction whose pattern fires on the ENEMY_FIRE timer
+    int volleyIndex = 0;      // Advances spirals and waves
+	// Constructor
+    Enemy(const sf::Texture& texture, float x, float y, float cooldown)
+        : sprite(texture), startX(x), shootCooldown(cooldown)
+    {
+        sprite.setPosition({ x, y });
+        sprite.setScale({ ArtScale::draw(ArtScale::enemy), ArtScale::draw(ArtScale::enemy) });
+        sf::FloatRect bounds = sprite.getLocalBounds();
+        sprite.setOrigin({ bounds.size.x / 2.f, bounds.size.y / 2.f });
+        halfWidth = bounds.size.x * sprite.getScale().x / 2.f;
+    }
+	// Get enemy bounds and position
+    sf::FloatRect getGlobalBounds() const { return sprite.getGlobalBounds(); }
+    const sf::Vector2f& getPosition() const { return sprite.getPosition(); }
+    int getHp() const { return hp; }
+	// Hand control to a behaviour program
+    void runBehaviour(int program, int programHp) {
+        behaviour = program;
+        pc = 0; opTimer = 0.f; autofireOp = -1;
+        hp = programHp;
+    }
+	// damage enemy
+    void takeDamage(int damage) {
+        hp -= damage;
+        if (hp < 0) hp = 0;
+    }
+	// Render enemy
+    void render(sf::RenderTarget& target) { target.draw(sprite); }
+};
+
+// ============================================================================
+// FLOW FIELD
+// ============================================================================
+// Shared steering field for swarm drones. Once per tick a coarse grid is
+// solved with Dijkstra from the goal cells (one formation anchor per player),
+// with avoidance zones raising the cost of the cells they cover; each cell then
+// points at its cheapest neighbour. A drone only reads one cell, so steering
+// costs the same per drone whether a wave has ten drones or a thousand.
+struct FlowField {
+    static constexpr float cellSize = 40.f;
+    static constexpr int columns = static_cast<int>(Playfield::width / cellSize);
+    static constexpr int rows = static_cast<int>((Playfield::height + cellSize - 1.f) / cellSize);
+    static constexpr int cells = columns * rows;
+
+    std::vector<float> cost, distance, dirX, dirY;
+    std::vector<std::pair<float, std::uint32_t>> open;  // Dijkstra heap, reused every tick
+    std::vector<std::uint32_t> goals;
+
+    FlowField() : cost(cells), distance(cells), dirX(cells), dirY(cells) { open.reserve(cells * 4); goals.reserve(16); }
+
+	// Start a new tick: every cell costs 1, no goals
+    void clear() {
+        std::fill(cost.begin(), cost.end(), 1.f);
+        goals.clear();
+    }
+	// Cell a formation gathers around
+    void addGoal(sf::Vector2f pos) { goals.push_back(static_cast<std::uint32_t>(cell(pos))); }
+	// Make cells within radius more expensive to cross
+    void addAvoidance(sf::Vector2f center, float radius, float penalty) {
+        int x0 = column(center.x - radius), x1 = column(center.x + radius);
+        int y0 = row(center.y - radius), y1 = row(center.y + radius);
+        for (int y = y0; y <= y1; y++)
+            for (int x = x0; x <= x1; x++) {
+                float dx = (x + 0.5f) * cellSize - center.x, dy = (y + 0.5f) * cellSize - center.y;
+                if (dx * dx + dy * dy <= radius * radius) cost[y * columns + x] += penalty;
+            }
+    }
+	// Distance to the nearest goal for every cell, then the downhill direction
+    void solve() {
+        std::fill(distance.begin(), distance.end(), 1e30f);
+        open.clear();
+        for (std::uint32_t g : goals) { distance[g] = 0.f; open.push_back({ 0.f, g }); }
+        std::make_heap(open.begin(), open.end(), std::greater<>());
+        static constexpr int offsetX[8] = { -1, 0, 1, -1, 1, -1, 0, 1 };
+        static constexpr int offsetY[8] = { -1, -1, -1, 0, 0, 1, 1, 1 };
+        static constexpr float step[8] = { 1.4142f, 1.f, 1.4142f, 1.f, 1.f, 1.4142f, 1.f, 1.4142f };
+        while (!open.empty()) {
+            std::pop_heap(open.begin(), open.end(), std::greater<>());
+            auto [d, c] = open.back();
+            open.pop_back();
+            if (d > distance[c]) continue;
+            int cx = static_cast<int>(c) % columns, cy = static_cast<int>(c) / columns;
+            for (int n = 0; n < 8; n++) {
+                int x = cx + offsetX[n], y = cy + offsetY[n];
+                if (x < 0 || x >= columns || y < 0 || y >= rows) continue;
+                std::uint32_t next = static_cast<std::uint32_t>(y * columns + x);
+                float nd = d + step[n] * cost[next];
+                if (nd < distance[next]) {
+                    distance[next] = nd;
+                    open.push_back({ nd, next });
+                    std::push_heap(open.begin(), open.end(), std::greater<>());
+                }
+            }
+        }
+		// Point each cell at its cheapest neighbour (goal cells stay still)
+        for (int c = 0; c < cells; c++) {
+            int cx = c % columns, cy = c / columns;
+            float best = distance[c];
+            dirX[c] = 0.f; dirY[c] = 0.f;
+            for (int n = 0; n < 8; n++) {
+                int x = cx + offsetX[n], y = cy + offsetY[n];
+                if (x < 0 || x >= columns || y < 0 || y >= rows || distance[y * columns + x] >= best) continue;
+                best = distance[y * columns + x];
+                dirX[c] = offsetX[n] / step[n]; dirY[c] = offsetY[n] / step[n];
+            }
+        }
+    }
+	// Unit steering direction at a position (zero at a goal)
+    sf::Vector2f sample(sf::Vector2f pos) const {
+        int c = cell(pos);
+        return { dirX[c], dirY[c] };
+    }
+
+    static int column(float x) { return std::max(0, std::min(static_cast<int>(std::floor(x / cellSize)), columns - 1)); }
+    static int row(float y) { return std::max(0, std::min(static_cast<int>(std::floor(y / cellSize)), rows - 1)); }
+    static int cell(sf::Vector2f pos) { return row(pos.y) * columns + column(pos.x); }
+};
+
+// ============================================================================
+// SWARM DRONES
+// ============================================================================
+// Swarm waves of hundreds of small drones, kept apart from Enemy: flat arrays
+// with no sprite per drone, drawn as one textured vertex batch. Each drone
+// samples the flow field at its position minus its formation slot, so it
+// settles into its own slot around the anchor; after holding for a while it
+// dives off the bottom. Drones do not shoot, they ram. Storage is reserved
+// for maxDrones (also the snapshot limit), so a full swarm never allocates.
+struct SwarmDrones {
+    static constexpr std::size_t maxDrones = 1024;
+    static constexpr float size = 26.f;  // On-screen width and height
+    static constexpr float speed = 180.f, steering = 3.f, diveSpeed = 320.f;
+    static constexpr int hp = 10;        // One player bullet
+
+    std::vector<float> x, y, velocityX, velocityY, slotX, slotY, age, diveAt;
+    std::vector<std::int32_t> health;
+    std::vector<sf::Vertex> vertices;    // Six per drone, rebuilt every render
+
+	// Constructor
+    SwarmDrones() {
+        for (auto* v : { &x, &y, &velocityX, &velocityY, &slotX, &slotY, &age, &diveAt }) v->reserve(maxDrones);
+        health.reserve(maxDrones);
+        vertices.reserve(maxDrones * 6);
+    }
+    std::size_t count() const { return x.size(); }
+    bool empty() const { return x.empty(); }
+    void clear() { resize(0); }
+	// Add a drone heading for a formation slot; false when full
+    bool add(sf::Vector2f pos, sf::Vector2f slot, float diveTime) {
+        if (count() >= maxDrones) return false;
+        x.push_back(pos.x); y.push_back(pos.y); velocityX.push_back(0.f); velocityY.push_back(0.f);
+        slotX.push_back(slot.x); slotY.push_back(slot.y); age.push_back(0.f); diveAt.push_back(diveTime);
+        health.push_back(hp);
+        return true;
+    }
+    sf::FloatRect bounds(std::size_t i) const { return { { x[i] - size / 2.f, y[i] - size / 2.f }, { size, size } }; }
+
+	// Ease every drone's velocity toward its slot (or straight down once diving) and move it
+    void step(float dt, const FlowField& field, float playfieldWidth) {
+        float blend = std::min(1.f, steering * dt);
+        for (std::size_t i = 0; i < count(); i++) {
+            age[i] += dt;
+            sf::Vector2f desired = age[i] >= diveAt[i] ? sf::Vector2f(0.f, diveSpeed)
+                : field.sample({ x[i] - slotX[i], y[i] - slotY[i] }) * speed;
+            velocityX[i] += (desired.x - velocityX[i]) * blend;
+            velocityY[i] += (desired.y - velocityY[i]) * blend;
+            x[i] = std::max(size / 2.f, std::min(x[i] + velocityX[i] * dt, playfieldWidth - size / 2.f));
+            y[i] += velocityY[i] * dt;
+        }
+    }
+	// Remove destroyed drones and those that left the playfield, keeping order; destroyed(pos) runs for each destroyed one
+    template <typename Fn>
+    void compact(Fn destroyed) {
+        std::size_t kept = 0;
+        for (std::size_t i = 0; i < count(); i++) {
+            if (health[i] <= 0) { destroyed(sf::Vector2f(x[i], y[i])); continue; }
+            if (!Playfield::contains(bounds(i))) continue;
+            x[kept] = x[i]; y[kept] = y[i]; velocityX[kept] = velocityX[i]; velocityY[kept] = velocityY[i];
+            slotX[kept] = slotX[i]; slotY[kept] = slotY[i]; age[kept] = age[i]; diveAt[kept] = diveAt[i];
+            health[kept] = health[i];
+            kept++;
+        }
+        resize(kept);
+    }
+    void resize(std::size_t n) {
+        for (auto* v : { &x, &y, &velocityX, &velocityY, &slotX, &slotY, &age, &diveAt }) v->resize(n);
+        health.resize(n);
+    }
+
+	// One draw call for the whole swarm (tinted so drones read apart from the sweepers)
+    void render(sf::RenderTarget& target, const sf::Texture& texture) {
+        vertices.clear();
+        const sf::Color tint(170, 220, 255);
+        float tw = static_cast<float>(texture.getSize().x), th = static_cast<float>(texture.getSize().y);
+        for (std::size_t i = 0; i < count(); i++) {
+            if (health[i] <= 0 || !Playfield::visible(bounds(i))) continue;
+            float l = x[i] - size / 2.f, t = y[i] - size / 2.f, r = l + size, b = t + size;
+            sf::Vertex corners[4] = { { { l, t }, tint, { 0.f, 0.f } }, { { r, t }, tint, { tw, 0.f } },
+                                      { { r, b }, tint, { tw, th } }, { { l, b }, tint, { 0.f, th } } };
+            for (int k : { 0, 1, 2, 0, 2, 3 }) vertices.push_back(corners[k]);
+        }
+        if (!vertices.empty()) target.draw(vertices.data(), vertices.size(), sf::PrimitiveType::Triangles, sf::RenderStates(&texture));
+    }
+};
+
+// ============================================================================
+// ENEMY KINEMATICS
+// ============================================================================
+// Branchless sine approximation (max error ~0.001), cheap enough to vectorize
+inline float fastSin(float x) {
+    const float twoPi = 6.28318530718f, invTwoPi = 0.159154943092f;
+    x -= twoPi * std::floor(x * invTwoPi + 0.5f);  // Wrap to [-pi, pi]
+    float y = 1.27323954474f * x - 0.405284734569f * x * std::fabs(x);
+    return 0.225f * (y * std::fabs(y) - y) + y;
+}
+
+// Updates every enemy in one pass: state is gathered into flat arrays, the
+// sine-wave movement runs as a straight-line loop the compiler can vectorize,
+// and the results are scattered back to the sprites. Shots are not timed
+// here; they come from ENEMY_FIRE timers on the timer wheel.
+struct EnemyKinematics {
+    std::vector<float> x, y, startX, sineTimer, halfWidth, speed;
+
+    void step(std::vector<Enemy>& enemies, float dt, float playfieldWidth) {
+        const std::size_t n = enemies.size();
+        resize(n);
+		// Gather
+        for (std::size_t i = 0; i < n; i++) {
+            const Enemy& e = enemies[i];
+            y[i] = e.sprite.getPosition().y;
+            startX[i] = e.startX;
+            sineTimer[i] = e.sineTimer;
+            halfWidth[i] = e.halfWidth;
+            speed[i] = e.speed;
+        }
+		// Movement: sine sweep around startX, clamped to the playfield
+        for (std::size_t i = 0; i < n; i++) {
+            sineTimer[i] += dt;
+            y[i] += speed[i] * dt;
+            float newX = startX[i] + fastSin(sineTimer[i] * 0.5f) * 100.f;
+            x[i] = std::max(halfWidth[i], std::min(newX, playfieldWidth - halfWidth[i]));
+        }
+		// Scatter
+        for (std::size_t i = 0; i < n; i++) {
+            Enemy& e = enemies[i];
+            if (e.behaviour >= 0) continue;  // Moved by its behaviour program
+            e.sineTimer = sineTimer[i];
+            e.sprite.setPosition({ x[i], y[i] });
+        }
+    }
+
+    void resize(std::size_t n) {
+        for (auto* v : { &x, &y, &startX, &sineTimer, &halfWidth, &speed }) v->resize(n);
+    }
+    void reserve(std::size_t n) {
+        for (auto* v : { &x, &y, &startX, &sineTimer, &halfWidth, &speed }) v->reserve(n);
+    }
+};
+
+// ============================================================================
+// BOSS
+// ============================================================================
+// Emit one volley of a pattern (table lookups only, no trigonometry)
+inline void fireVolley(const PatternRef& pattern, int volleyIndex, sf::Vector2f spawn, sf::Vector2f target, float speed,
+                       std::vector<Bullet>& bullets, const sf::Texture& bulletTex) {
+    if (!pattern.shots) return;
+    int volley = volleyIndex % pattern.volleys;
+    if (pattern.aimed) {
+        // Pick the pre-rotated heading closest to the target
+        sf::Vector2f toTarget = target - spawn;
+        float bestDot = -1e30f;
+        for (int h = 0; h < BulletPatterns::aimHeadings; h++) {
+            const PatternShot& heading = BulletPatterns::headings.shots[h];
+            float dot = heading.dirX * toTarget.x + heading.dirY * toTarget.y;
+            if (dot > bestDot) { bestDot = dot; volley = h; }
+        }
+    }
+    const PatternShot* shots = pattern.shots + volley * pattern.shotsPerVolley;
+    for (int i = 0; i < pattern.shotsPerVolley; i++) {
+        bullets.emplace_back(bulletTex, spawn.x, spawn.y, shots[i]);
+        bullets.back().speed = speed * pattern.speedScale;
+    }
+}
+
+struct Boss {
+    sf::Sprite sprite;
+    sf::RectangleShape hpBarOuter, hpBarInner;
+	// Boss attributes
+    int hp, maxHp;
+    float speed = 75.f;
+    bool movingRight = true;
+    float attackMax = 1.25f;   // Seconds between volleys, scaled by the phase
+    float bulletSpeed;  // Configurable bullet speed
+    int volleyIndex = 0;  // Advances spirals and waves
+
+	// Constructor
+    Boss(const sf::Texture& texture, int health, float bSpeed) 
+        : sprite(texture), hp(health), maxHp(health), bulletSpeed(bSpeed) 
+    {
+        sprite.setScale({ ArtScale::draw(ArtScale::boss), ArtScale::draw(ArtScale::boss) });
+        sf::FloatRect bounds = sprite.getLocalBounds();
+        sprite.setOrigin({ bounds.size.x / 2.f, bounds.size.y / 2.f });
+
+        hpBarOuter.setSize({ 200.f, 20.f });
+        hpBarOuter.setFillColor(sf::Color::Transparent);
+        hpBarOuter.setOutlineColor(sf::Color::Red);
+        hpBarOuter.setOutlineThickness(2.f);
+
+        hpBarInner.setSize({ 200.f, 20.f });
+        hpBarInner.setFillColor(sf::Color::Red);
+    }
+	// Update boss state
+    void update(sf::Time dt, sf::Vector2u windowSize) {
+        sf::Vector2f pos = sprite.getPosition();
+        float windowWidth = static_cast<float>(windowSize.x);
+		// Move boss left and right
+        if (movingRight) {
+            pos.x += speed * dt.asSeconds();
+            if (pos.x + sprite.getGlobalBounds().size.x / 2.f > windowWidth) movingRight = false;
+        } else {
+            pos.x -= speed * dt.asSeconds();
+            if (pos.x - sprite.getGlobalBounds().size.x / 2.f < 0.f) movingRight = true;
+        }
+        if (pos.y < 150.f) pos.y += 50.f * dt.asSeconds();
+        sprite.setPosition(pos);
+		// Update HP bar
+        hpBarOuter.setPosition({ pos.x - 100.f, pos.y - 100.f });
+        hpBarInner.setPosition({ pos.x - 100.f, pos.y - 100.f });
+        float hpPercent = std::max(0.f, static_cast<float>(hp) / static_cast<float>(maxHp));
+        hpBarInner.setSize({ 200.f * hpPercent, 20.f });
+    }
+	// Fire one volley with the patterns of the current HP phase
+    void attack(sf::Vector2f target, std::vector<Bullet>& enemyBullets, const sf::Texture& bulletTex) {
+        sf::Vector2f spawn = { getPosition().x, getPosition().y + sprite.getGlobalBounds().size.y / 2.f };
+        for (const PatternRef& pattern : currentPhase().patterns) fireVolley(pattern, volleyIndex, spawn, target, bulletSpeed, enemyBullets, bulletTex);
+        volleyIndex++;
+    }
+	// Delay until the next volley
+    float attackInterval() const { return attackMax * currentPhase().attackScale; }
+	// Last phase whose HP threshold has been reached
+    const BossPhase& currentPhase() const {
+        float hpFraction = static_cast<float>(hp) / static_cast<float>(maxHp);
+        const BossPhase* phase = &bossPhases[0];
+        for (const BossPhase& p : bossPhases) if (hpFraction <= p.hpFraction) phase = &p;
+        return *phase;
+    }
+	// Render boss
+    void render(sf::RenderTarget& target) {
+        target.draw(sprite);
+        target.draw(hpBarOuter);
+        target.draw(hpBarInner);
+    }
+	//  damage boss
+    void takeDamage(int damage) { hp -= damage; }
+    sf::FloatRect getGlobalBounds() const { return sprite.getGlobalBounds(); }
+    sf::Vector2f getPosition() const { return sprite.getPosition(); }
+    bool isAlive() const { return hp > 0; }
+};
+
+// ============================================================================
+// SPATIAL INDEX
+// ============================================================================
+// Uniform grid over the live playfield, rebuilt each frame with a counting
+// sort so every cell's targets sit contiguously. Queries visit only the cells
+// they overlap, so nearest and radius lookups cost O(1) on average and a ray
+// walks the cells along its line. Targets bigger than half a cell (the boss)
+// are kept in a short side list that every query checks directly.
+struct SpatialIndex {
+    enum Kind : std::uint8_t { ENEMY, ASTEROID, BOSS, DRONE };
+    struct Target { float x, y, radius; std::uint32_t index; Kind kind; };
+
+    static constexpr float cellSize = 100.f;
+    static constexpr float originX = -Playfield::lifeMargin, originY = -Playfield::lifeMargin;
+    static constexpr int columns = static_cast<int>((Playfield::width + 2.f * Playfield::lifeMargin) / cellSize);
+    static constexpr int rows = static_cast<int>((Playfield::height + 2.f * Playfield::lifeMargin) / cellSize);
+
+    std::vector<Target> pending, targets, oversized;  // Input, then grouped by cell
+    std::array<std::uint32_t, columns * rows + 1> cellStart{};
+
+    void reserve(std::size_t n) { pending.reserve(n); targets.reserve(n); oversized.reserve(4); }
+
+	// Index the live targets; indices refer to the containers passed in
+    void build(const std::vector<Enemy>& enemies, const std::vector<Asteroid>& asteroids, const Boss* boss, const SwarmDrones& drones) {
+        pending.clear(); oversized.clear();
+        for (std::size_t i = 0; i < enemies.size(); i++) add(enemies[i].getGlobalBounds(), i, ENEMY);
+        for (std::size_t i = 0; i < drones.count(); i++) if (drones.health[i] > 0) add(drones.bounds(i), i, DRONE);
+        for (std::size_t i = 0; i < asteroids.size(); i++) if (asteroids[i].isAlive) add(asteroids[i].getGlobalBounds(), i, ASTEROID);
+        if (boss && boss->isAlive()) add(boss->getGlobalBounds(), 0, BOSS);
+		// Counting sort by cell
+        cellStart.fill(0);
+        for (const Target& t : pending) cellStart[cell(t.x, t.y) + 1]++;
+        for (int c = 0; c < columns * rows; c++) cellStart[c + 1] += cellStart[c];
+        std::array<std::uint32_t, columns * rows> cursor;
+        std::copy(cellStart.begin(), cellStart.end() - 1, cursor.begin());
+        targets.resize(pending.size());
+        for (const Target& t : pending) targets[cursor[cell(t.x, t.y)]++] = t;
+    }
+
+	// Closest target centre within maxDistance, or null
+    const Target* nearest(sf::Vector2f p, float maxDistance) const {
+        const Target* best = nullptr;
+        float bestDistSq = maxDistance * maxDistance;
+        auto consider = [&](const Target& t) {
+            float dx = t.x - p.x, dy = t.y - p.y, distSq = dx * dx + dy * dy;
+            if (distSq < bestDistSq) { bestDistSq = distSq; best = &t; }
+        };
+        for (const Target& t : oversized) consider(t);
+		// Grow rings of cells until the ring is farther away than the best hit
+        int cx = column(p.x), cy = row(p.y);
+        for (int ring = 0; ring < std::max(columns, rows); ring++) {
+            float ringDistance = (ring - 1) * cellSize;
+            if (ring > 1 && ringDistance * ringDistance > bestDistSq) break;
+            for (int y = cy - ring; y <= cy + ring; y++) {
+                if (y < 0 || y >= rows) continue;
+                int step = (y == cy - ring || y == cy + ring) ? 1 : 2 * ring;
+                for (int x = cx - ring; x <= cx + ring; x += std::max(step, 1)) {
+                    if (x < 0 || x >= columns) continue;
+                    int c = y * columns + x;
+                    for (std::uint32_t i = cellStart[c]; i < cellStart[c + 1]; i++) consider(targets[i]);
+                }
+            }
+        }
+        return best;
+    }
+
+	// Every target whose circle overlaps the query circle
+    template <typename Fn>
+    void forEachInRadius(sf::Vector2f p, float radius, Fn&& fn) const {
+        visitRadius(p, radius, [&](const Target& t) { fn(t); return false; });
+    }
+	// First target found overlapping the query circle, or null
+    const Target* firstInRadius(sf::Vector2f p, float radius) const {
+        return firstInRadius(p, radius, [](const Target&) { return true; });
+    }
+	// First overlapping target that accept(target) lets through, or null
+    template <typename Accept>
+    const Target* firstInRadius(sf::Vector2f p, float radius, Accept&& accept) const {
+        const Target* found = nullptr;
+        visitRadius(p, radius, [&](const Target& t) { if (!accept(t)) return false; found = &t; return true; });
+        return found;
+    }
+
+	// First target hit by a ray (dir must be unit length), or null
+    const Target* raycast(sf::Vector2f origin, sf::Vector2f dir, float maxDistance, float* hitDistance = nullptr) const {
+        const Target* best = nullptr;
+        float bestT = maxDistance;
+        auto consider = [&](const Target& t) {
+            float ox = t.x - origin.x, oy = t.y - origin.y;
+            float along = ox * dir.x + oy * dir.y;
+            float offSq = ox * ox + oy * oy - along * along;
+            float radiusSq = t.radius * t.radius;
+            if (offSq > radiusSq) return;
+            float half = std::sqrt(radiusSq - offSq);
+            if (along + half < 0.f) return;
+            float enter = std::max(0.f, along - half);
+            if (enter < bestT) { bestT = enter; best = &t; }
+        };
+        for (const Target& t : oversized) consider(t);
+		// Walk the crossed cells; a target centred in a neighbouring cell can still
+		// reach the ray, so each step scans the 3x3 block around the cell
+        float gx = (origin.x - originX) / cellSize, gy = (origin.y - originY) / cellSize;
+        int cx = static_cast<int>(std::floor(gx)), cy = static_cast<int>(std::floor(gy));
+        int stepX = dir.x >= 0.f ? 1 : -1, stepY = dir.y >= 0.f ? 1 : -1;
+        const float never = 1e30f;
+        float deltaX = dir.x != 0.f ? cellSize / std::fabs(dir.x) : never;
+        float deltaY = dir.y != 0.f ? cellSize / std::fabs(dir.y) : never;
+        float nextX = dir.x != 0.f ? (stepX > 0 ? cx + 1 - gx : gx - cx) * deltaX : never;
+        float nextY = dir.y != 0.f ? (stepY > 0 ? cy + 1 - gy : gy - cy) * deltaY : never;
+        float t = 0.f;
+        while (t <= maxDistance + cellSize && t <= bestT + 2.f * cellSize) {
+            for (int y = std::max(cy - 1, 0); y <= std::min(cy + 1, rows - 1); y++)
+                for (int x = std::max(cx - 1, 0); x <= std::min(cx + 1, columns - 1); x++) {
+                    int c = y * columns + x;
+                    for (std::uint32_t i = cellStart[c]; i < cellStart[c + 1]; i++) consider(targets[i]);
+                }
+            if (nextX < nextY) { t = nextX; nextX += deltaX; cx += stepX; }
+            else { t = nextY; nextY += deltaY; cy += stepY; }
+        }
+        if (best && hitDistance) *hitDistance = bestT;
+        return best;
+    }
+
+    static int column(float x) { return std::max(0, std::min(static_cast<int>(std::floor((x - originX) / cellSize)), columns - 1)); }
+    static int row(float y) { return std::max(0, std::min(static_cast<int>(std::floor((y - originY) / cellSize)), rows - 1)); }
+    static int cell(float x, float y) { return row(y) * columns + column(x); }
+
+private:
+    void add(const sf::FloatRect& bounds, std::size_t index, Kind kind) {
+        Target t{ bounds.position.x + bounds.size.x / 2.f, bounds.position.y + bounds.size.y / 2.f,
+                  (bounds.size.x + bounds.size.y) / 4.f, static_cast<std::uint32_t>(index), kind };
+        if (t.radius > cellSize / 2.f) oversized.push_back(t);
+        else pending.push_back(t);
+    }
+	// Visit overlapping targets until fn returns true; returns whether it did
+    template <typename Fn>
+    bool visitRadius(sf::Vector2f p, float radius, Fn&& fn) const {
+        auto overlaps = [&](const Target& t) {
+            float dx = t.x - p.x, dy = t.y - p.y, reach = radius + t.radius;
+            return dx * dx + dy * dy <= reach * reach;
+        };
+        for (const Target& t : oversized) if (overlaps(t) && fn(t)) return true;
+        float reach = radius + cellSize / 2.f;
+        for (int y = row(p.y - reach); y <= row(p.y + reach); y++)
+            for (int x = column(p.x - reach); x <= column(p.x + reach); x++) {
+                int c = y * columns + x;
+                for (std::uint32_t i = cellStart[c]; i < cellStart[c + 1]; i++)
+                    if (overlaps(targets[i]) && fn(targets[i])) return true;
+            }
+        return false;
+    }
+};
+
+// ============================================================================
+// PLAYER
+// ============================================================================
+// One frame of player controls as a bitmask, small enough to send over the network
+struct PlayerInput {
+    enum Bits : std::uint8_t { UP = 1, DOWN = 2, LEFT = 4, RIGHT = 8, ROTATE_LEFT = 16, ROTATE_RIGHT = 32 };
+    std::uint8_t bits = 0;
+
+    bool has(Bits b) const { return (bits & b) != 0; }
+	// Sample the local keyboard
+    static PlayerInput fromKeyboard() {
+        PlayerInput input;
+        if (sf::Keyboard::isKeyPressed(sf::Keyboard::Key::W) || sf::Keyboard::isKeyPressed(sf::Keyboard::Key::Up)) input.bits |= UP;
+        if (sf::Keyboard::isKeyPressed(sf::Keyboard::Key::S) || sf::Keyboard::isKeyPressed(sf::Keyboard::Key::Down)) input.bits |= DOWN;
+        if (sf::Keyboard::isKeyPressed(sf::Keyboard::Key::A)) input.bits |= LEFT;
+        if (sf::Keyboard::isKeyPressed(sf::Keyboard::Key::D)) input.bits |= RIGHT;
+        if (sf::Keyboard::isKeyPressed(sf::Keyboard::Key::Left)) input.bits |= ROTATE_LEFT;
+        if (sf::Keyboard::isKeyPressed(sf::Keyboard::Key::Right)) input.bits |= ROTATE_RIGHT;
+        return input;
+    }
+};
+
+struct Player {
+    sf::Sprite sprite;
+    sf::Vector2f velocity;
+	// Player attributes
+    float movementSpeed = 400.f;
+    float attackCooldown = 0.2f;
+    bool attackReady = true;                   // Set again by an ATTACK_READY timer
+    TimerWheel::Handle tripleShot, homing;     // Pending end of each timed powerup
+    float rotationSpeed = 150.f;
+	// Banking: the frame steps from bankFrom toward bankTarget, one per animSpeed since bankStart
+    int bankFrom = 2, bankTarget = 2;
+    float bankStart = 0.f;
+    float animSpeed = 0.05f;
+
+	// Constructor
+    Player(const std::vector<TextureHandle>& tex) : sprite(*tex[2]) {
+        sprite.setScale({ 1.65f, 1.65f });
+        sf::FloatRect bounds = sprite.getLocalBounds();
+        sprite.setOrigin({ bounds.size.x / 2.f, bounds.size.y / 2.f });
+    }
+	// Get player position and bounds
+    const sf::Vector2f& getPosition() const { return sprite.getPosition(); }
+    sf::FloatRect getGlobalBounds() const { return sprite.getGlobalBounds(); }
+    sf::Angle getRotation() const { return sprite.getRotation(); }
+
+	// Set player position
+    void setPosition(float x, float y) { sprite.setPosition({ x, y }); }
+    bool isTripleShotActive() const { return !tripleShot.empty(); }
+    bool isHomingActive() const { return !homing.empty(); }
+	// Ready to fire with no powerups (the run's timers were cleared)
+    void resetEffects() { attackReady = true; tripleShot = homing = TimerWheel::Handle(); }
+	// Banking frame at a run time (index into the PLAYER_BANK clip)
+    int bankFrame(float now) const {
+        int steps = std::max(0, static_cast<int>((now - bankStart) / animSpeed));
+        return bankFrom < bankTarget ? std::min(bankFrom + steps, bankTarget) : std::max(bankFrom - steps, bankTarget);
+    }
+    void resetBank() { bankFrom = bankTarget = 2; bankStart = 0.f; }
+	
+    // Update player state
+    void update(sf::Time dt, const sf::Vector2u& windowSize, const PlayerInput& input, float now) {
+		// Reset velocity
+        velocity = { 0.f, 0.f };
+        bool movingLeft = false, movingRight = false;
+
+		// Handle input
+        if (input.has(PlayerInput::UP)) velocity.y = -1.f;
+        if (input.has(PlayerInput::DOWN)) velocity.y = 1.f;
+        if (input.has(PlayerInput::LEFT)) { velocity.x = -1.f; movingLeft = true; }
+        if (input.has(PlayerInput::RIGHT)) { velocity.x = 1.f; movingRight = true; }
+        if (input.has(PlayerInput::ROTATE_LEFT)) sprite.rotate(sf::degrees(-rotationSpeed * dt.asSeconds()));
+        if (input.has(PlayerInput::ROTATE_RIGHT)) sprite.rotate(sf::degrees(rotationSpeed * dt.asSeconds()));
+		
+        // Bank toward the new target from wherever the animation is now
+        int targetFrame = 2;
+        if (movingLeft) targetFrame = 0;
+        else if (movingRight) targetFrame = 4;
+        if (targetFrame != bankTarget) {
+            bankFrom = bankFrame(now);
+            bankTarget = targetFrame;
+            bankStart = now;
+        }
+		// Normalize velocity and move player
+        if (velocity.x != 0.f || velocity.y != 0.f) {
+            float length = std::sqrt(velocity.x * velocity.x + velocity.y * velocity.y);
+            velocity /= length;
+            sprite.move(velocity * movementSpeed * dt.asSeconds());
+        }
+		// Keep player within window bounds
+        sf::Vector2f pos = sprite.getPosition();
+        sf::FloatRect bounds = sprite.getGlobalBounds();
+        float halfW = bounds.size.x / 2.f, halfH = bounds.size.y / 2.f;
+        if (pos.x - halfW < 0.f) pos.x = halfW;
+        if (pos.x + halfW > static_cast<float>(windowSize.x)) pos.x = static_cast<float>(windowSize.x) - halfW;
+        if (pos.y - halfH < 0.f) pos.y = halfH;
+        if (pos.y + halfH > static_cast<float>(windowSize.y)) pos.y = static_cast<float>(windowSize.y) - halfH;
+        sprite.setPosition(pos);
+    }
+	// Render player
+    void render(sf::RenderTarget& target, const AnimationClip& bank, float now) {
+        bank.applyFrame(sprite, bankFrame(now));
+        target.draw(sprite);
+    }
+};
+
+// ============================================================================
+// STAR FIELD
+// ============================================================================
+struct Star {
+    sf::CircleShape shape;
+    float speed;
+};
+
+struct StarField {
+    std::vector<Star> stars;
+    sf::Vector2u windowSize;
+	// Constructor
+    StarField(int count, sf::Vector2u winSize) : windowSize(winSize) {
+        stars.resize(count);
+        for (auto& star : stars) {
+            float x = static_cast<float>(rand() % windowSize.x);
+            float y = static_cast<float>(rand() % windowSize.y);
+            float size = static_cast<float>((rand() % 3) + 1);
+            star.shape.setRadius(size);
+            star.shape.setPosition({ x, y });
+            int brightness = (rand() % 100) + 155;
+            star.shape.setFillColor(sf::Color(255, 255, 255, brightness));
+            star.speed = size * 40.f;
+        }
+    }
+	// Update star positions
+    void update(sf::Time dt) {
+        for (auto& star : stars) {
+            star.shape.move({ 0.f, star.speed * dt.asSeconds() });
+            if (star.shape.getPosition().y > windowSize.y) {
+                float x = static_cast<float>(rand() % windowSize.x);
+                star.shape.setPosition({ x, -5.f });
+            }
+        }
+    }
+	// Render stars
+    void render(sf::RenderTarget& target) {
+        for (const auto& star : stars) target.draw(star.shape);
+    }
+};
+
+// ============================================================================
+// SCROLLING BACKGROUND
+// ============================================================================
+struct ScrollingBackground {
+    sf::Sprite bg1, bg2;
+    float scrollSpeed;
+    float textureHeight;
+	// Constructor
+    ScrollingBackground(const sf::Texture& texture, float speed)
+        : bg1(texture), bg2(texture), scrollSpeed(speed)
+    {
+        textureHeight = static_cast<float>(texture.getSize().y);
+        bg1.setPosition({ 0.f, 0.f });
+        bg2.setPosition({ 0.f, -textureHeight });
+    }
+	// Update background positions
+    void update(sf::Time dt) {
+        float movement = scrollSpeed * dt.asSeconds();
+        bg1.move({ 0.f, movement });
+        bg2.move({ 0.f, movement });
+        sf::Vector2f pos1 = bg1.getPosition(), pos2 = bg2.getPosition();
+        if (pos1.y >= textureHeight) bg1.setPosition({ 0.f, pos2.y - textureHeight });
+        if (pos2.y >= textureHeight) bg2.setPosition({ 0.f, pos1.y - textureHeight });
+    }
+	// Render background
+    void render(sf::RenderTarget& target) {
+        target.draw(bg1);
+        target.draw(bg2);
+    }
+};
+
+// ============================================================================
+// SCREEN SHAKE
+// ============================================================================
+struct ScreenShake {
+    float shakeAmount = 0.f;
+    float shakeDuration = 0.f;
+    float shakeTimer = 0.f;
+    float maxShakeDuration = 0.f;
+	// Start screen shake
+    void shake(float amount, float duration) {
+        shakeAmount = amount;
+        shakeDuration = duration;
+        maxShakeDuration = duration;
+        shakeTimer = 0.f;
+    }
+	// Update shake timer
+    void update(sf::Time dt) {
+        if (shakeTimer < shakeDuration) shakeTimer += dt.asSeconds();
+    }
+	// Get current shake offset
+    sf::Vector2f getOffset() const {
+        if (shakeTimer >= shakeDuration) return { 0.f, 0.f };
+        float intensity = (shakeDuration - shakeTimer) / maxShakeDuration;
+        float offsetX = std::sin(shakeTimer * 50.f) * shakeAmount * intensity;
+        float offsetY = std::sin(shakeTimer * 70.f) * shakeAmount * intensity;
+        return { offsetX, offsetY };
+    }
+};
+
+// ============================================================================
+// HUD
+// ============================================================================
+struct HUD {
+    FontHandle font;
+    sf::Text scoreText;
+    TextureHandle heartTex;
+    std::vector<sf::Sprite> hearts;
+    int score = 0;
+    int currentHearts = 10;
+    int maxHearts = 10;
+    int enemiesDefeated = 0;
+
+    // Power-up notification
+    sf::Text powerupText;
+    float powerupMessageTimer = 0.f;
+    float powerupMessageDuration = 2.f;  // Show message for 2 seconds
+    bool showPowerupMessage = false;
+
+    // Text is rewritten in place, reusing these buffers, so updates do not allocate
+    sf::String scoreString, messageString;
+    int displayedScore = -1;
+
+	// Constructor
+    explicit HUD(FontHandle f) : font(std::move(f)), scoreText(*font), powerupText(*font) {
+        scoreText.setCharacterSize(24);
+        scoreText.setFillColor(sf::Color::White);
+        scoreText.setPosition({ 10.f, 10.f });
+
+        // Setup power-up text
+        powerupText.setCharacterSize(18);
+        powerupText.setFillColor(sf::Color::Yellow);
+        powerupText.setOutlineColor(sf::Color::Black);
+        powerupText.setOutlineThickness(1.f);
+		powerupText.setPosition({ 10.f, 85.f }); // Below hearts
+
+        // Grow the buffers and load every printable glyph now rather than mid-game
+        for (char32_t c = 32; c < 127; c++) scoreString += sf::String(c);
+        messageString = scoreString;
+        scoreText.setString(scoreString); powerupText.setString(messageString);
+        static_cast<void>(scoreText.getLocalBounds()); static_cast<void>(powerupText.getLocalBounds());
+        refreshScoreText();
+    }
+
+	// Load HUD assets
+    bool loadAssets(ResourceCache& resources) {
+        heartTex = resources.tryTexture("assests/textures/player/heart.png");
+        if (!heartTex) return false;
+        hearts.clear();
+        for (int i = 0; i < maxHearts; i++) {
+            sf::Sprite heart(*heartTex);
+            heart.setScale({ 0.5f, 0.5f });
+            heart.setPosition({ 10.f + (i * 25.f), 50.f });
+            hearts.push_back(heart);
+        }
+        return true;
+    }
+
+	// Rewrite a text from ASCII, reusing the buffer's storage
+    static void assignText(sf::Text& text, sf::String& buffer, const char* ascii) {
+        buffer.clear();
+        for (const char* c = ascii; *c; c++) buffer += sf::String(static_cast<char32_t>(static_cast<unsigned char>(*c)));
+        text.setString(buffer);
+    }
+	// Score text, rebuilt only when the score changed
+    void refreshScoreText() {
+        if (score == displayedScore) return;
+        displayedScore = score;
+        char line[32];
+        std::snprintf(line, sizeof(line), "Score: %d", score);
+        assignText(scoreText, scoreString, line);
+    }
+
+	// Display power-up message
+    void showPowerup(const char* message) {
+        assignText(powerupText, messageString, message);
+        showPowerupMessage = true;
+        powerupMessageTimer = 0.f;
+    }
+
+	// Score and health management
+    void addScore(int points) { score += points; refreshScoreText(); }
+    int getScore() const { return score; }
+    void loseHeart() { if (currentHearts > 0) currentHearts--; }
+    bool isAlive() const { return currentHearts > 0; }
+    void heal(int amount) { currentHearts = std::min(currentHearts + amount, maxHearts); }
+    void addEnemyDefeated() { enemiesDefeated++; }
+    const sf::Font& getFont() const { return *font; }
+    const FontHandle& getFontHandle() const { return font; }
+
+	// Dynamic spawn rate multiplier based on score
+    float getSpawnRateMultiplier() const {
+    // Increase spawn rate based on score
+    // Every 100 points increases spawn rate by 0.2
+        float multiplier = 1.0f + (score / 100) * 0.2f;
+        // Cap at 2.2 maximum
+        return std::min(multiplier, 2.2f);
+    }
+
+	// Update HUD elements
+    void update(sf::Time dt) { 
+        refreshScoreText();
+
+        // Update power-up message timer
+        if (showPowerupMessage) {
+            powerupMessageTimer += dt.asSeconds();
+            if (powerupMessageTimer >= powerupMessageDuration) {
+                showPowerupMessage = false;
+            }
+        }
+    }
+
+	// Render HUD elements
+    void render(sf::RenderTarget& target) {
+        target.draw(scoreText);
+        for (int i = 0; i < currentHearts; i++) target.draw(hearts[i]);
+
+        // Draw power-up message with fade effect
+        if (showPowerupMessage) {
+            float alpha = 1.f - (powerupMessageTimer / powerupMessageDuration);
+            sf::Color color = powerupText.getFillColor();
+            color.a = static_cast<std::uint8_t>(255 * alpha);
+            powerupText.setFillColor(color);
+
+            sf::Color outlineColor = powerupText.getOutlineColor();
+            outlineColor.a = static_cast<std::uint8_t>(255 * alpha);
+            powerupText.setOutlineColor(outlineColor);
+
+            target.draw(powerupText);
+        }
+    }
+
+	// Reset HUD state
+    void reset() {
+        score = 0;
+        currentHearts = maxHearts;
+        enemiesDefeated = 0;
+        refreshScoreText();
+        showPowerupMessage = false;
+        powerupMessageTimer = 0.f;
+    }
+};
+
+// ============================================================================
+// CACHED LAYER
+// ============================================================================
+// Static part of a menu screen, composited once into a render texture and
+// redrawn only when its state key changes. The texture holds premultiplied
+// alpha, so translucent layers (the pause overlay) blend as if drawn directly.
+// It is sized at the target's pixels per logical unit (the resolution
+// scaler's scene scale), so a cached menu is as sharp as one drawn directly,
+// and scenes release it on exit so idle menus hold no texture during play.
+struct CachedLayer {
+    std::unique_ptr<sf::RenderTexture> texture;
+    std::optional<sf::Sprite> sprite;
+    std::uint64_t key = 0;
+    bool valid = false;
+    bool unsupported = false;  // No offscreen target, draw directly
+
+    CachedLayer() = default;
+    CachedLayer(const CachedLayer&) = delete;
+    CachedLayer& operator=(const CachedLayer&) = delete;
+
+	// Draw the cached quad, re-rendering through draw(target, states) when the key changed
+    template <typename DrawFn>
+    void render(sf::RenderTarget& target, std::uint64_t stateKey, DrawFn draw) {
+        float scale = static_cast<float>(target.getViewport(target.getView()).size.x) / target.getView().getSize().x;
+        sf::Vector2u size(static_cast<unsigned>(std::lround(Playfield::width * scale)), static_cast<unsigned>(std::lround(Playfield::height * scale)));
+        if (!unsupported && (!texture || texture->getSize() != size)) {
+            if (!texture) texture = std::make_unique<sf::RenderTexture>();
+            if (!texture->resize(size)) {
+                release();
+                unsupported = true;
+            }
+            else {
+                texture->setView(sf::View(sf::FloatRect({ 0.f, 0.f }, { Playfield::width, Playfield::height })));
+                sprite.emplace(texture->getTexture());
+                sprite->setScale({ Playfield::width / size.x, Playfield::height / size.y });
+                valid = false;
+            }
+        }
+        if (!texture) { draw(target, sf::RenderStates::Default); return; }
+        if (!valid || stateKey != key) {
+            texture->clear(sf::Color::Transparent);
+            draw(*texture, sf::RenderStates(sf::BlendMode(sf::BlendMode::Factor::SrcAlpha, sf::BlendMode::Factor::OneMinusSrcAlpha,
+                sf::BlendMode::Equation::Add, sf::BlendMode::Factor::One, sf::BlendMode::Factor::OneMinusSrcAlpha, sf::BlendMode::Equation::Add)));
+            texture->display();
+            key = stateKey;
+            valid = true;
+        }
+        target.draw(*sprite, sf::RenderStates(sf::BlendMode(sf::BlendMode::Factor::One, sf::BlendMode::Factor::OneMinusSrcAlpha)));
+    }
+	// Force a redraw (a texture or label changed)
+    void invalidate() { valid = false; }
+	// Free the render texture until the next render
+    void release() {
+        sprite.reset();
+        texture.reset();
+        valid = false;
+    }
+};
+
+// ============================================================================
+// MENU BUTTON
+// ============================================================================
+struct MenuIconButton {
+    sf::RectangleShape* rectangle = nullptr;
+    sf::Vector2f originalScale = { 1.f, 1.f };
+    sf::Vector2f originalPosition;
+    float animationTimer = 0.f;
+    float animationDuration = 0.15f;
+    bool isAnimating = false;
+    bool isSelected = false;
+    std::string label;
+};
+
+// ============================================================================
+// MENU
+// ============================================================================
+struct Menu {
+    sf::Sprite* menuBackground = nullptr;
+    std::vector<MenuIconButton> iconButtons;
+    int selectedIconIndex = 0;
+    bool startPressed = false;
+    bool exitPressed = false;
+    bool highScorePressed = false;
+    bool optionsPressed = false;  // Add this member variable
+    CachedLayer layer;
+
+    ~Menu() {
+        if (menuBackground) delete menuBackground;
+        for (auto& btn : iconButtons) if (btn.rectangle) delete btn.rectangle;
+    }
+
+    bool loadAssets(const sf::Texture* menuBgTexture) {
+        setBackground(menuBgTexture);
+
+        std::vector<std::string> buttonLabels = { "START GAME", "OPTIONS", "HIGH SCORE", "EXIT GAME" };
+        float buttonWidth = 240.f, buttonHeight = 55.f, buttonX = 95.f, startY = 575.f, spacing = 67.f;
+
+        for (size_t i = 0; i < 4; i++) {
+            sf::RectangleShape* rect = new sf::RectangleShape({ buttonWidth, buttonHeight });
+            rect->setFillColor(sf::Color::Transparent);
+            rect->setPosition({ buttonX, startY + (i * spacing) });
+
+            MenuIconButton btn;
+            btn.rectangle = rect;
+            btn.originalPosition = rect->getPosition();
+            btn.isSelected = (i == 0);
+            btn.label = buttonLabels[i];
+            iconButtons.push_back(btn);
+        }
+        return true;
+    }
+	// Swap the background texture (nullptr releases it)
+    void setBackground(const sf::Texture* menuBgTexture) {
+        if (menuBackground) { delete menuBackground; menuBackground = nullptr; }
+        layer.invalidate();
+        if (!menuBgTexture) { layer.release(); return; }
+        menuBackground = new sf::Sprite(*menuBgTexture);
+        float scaleX = Playfield::width / static_cast<float>(menuBgTexture->getSize().x);
+        float scaleY = Playfield::height / static_cast<float>(menuBgTexture->getSize().y);
+        menuBackground->setScale({ scaleX, scaleY });
+    }
+
+    void handleInput(const sf::Event& event, const sf::RenderWindow& window) {
+        if (const auto* keyEvent = event.getIf<sf::Event::KeyPressed>()) {
+            if (keyEvent->code == sf::Keyboard::Key::Up) {
+                selectedIconIndex = (selectedIconIndex - 1 + 4) % 4;
+                for (size_t i = 0; i < iconButtons.size(); i++) iconButtons[i].isSelected = (static_cast<int>(i) == selectedIconIndex);
+            } else if (keyEvent->code == sf::Keyboard::Key::Down) {
+                selectedIconIndex = (selectedIconIndex + 1) % 4;
+                for (size_t i = 0; i < iconButtons.size(); i++) iconButtons[i].isSelected = (static_cast<int>(i) == selectedIconIndex);
+            } else if (keyEvent->code == sf::Keyboard::Key::Enter) {
+                if (selectedIconIndex == 0) startPressed = true;
+                else if (selectedIconIndex == 1) optionsPressed = true;  // Add this
+                else if (selectedIconIndex == 2) highScorePressed = true;
+                else if (selectedIconIndex == 3) exitPressed = true;
+            }
+        }
+
+        if (const auto* moveEvent = event.getIf<sf::Event::MouseMoved>()) {
+            sf::Vector2f mousePos = window.mapPixelToCoords({ moveEvent->position.x, moveEvent->position.y });
+            for (size_t i = 0; i < iconButtons.size(); i++) {
+                if (iconButtons[i].rectangle && iconButtons[i].rectangle->getGlobalBounds().contains(mousePos)) {
+                    selectedIconIndex = static_cast<int>(i);
+                    for (size_t j = 0; j < iconButtons.size(); j++) iconButtons[j].isSelected = (j == i);
+                }
+            }
+        }
+
+        if (const auto* clickEvent = event.getIf<sf::Event::MouseButtonPressed>()) {
+            if (clickEvent->button == sf::Mouse::Button::Left) {
+                sf::Vector2f mousePos = window.mapPixelToCoords({ clickEvent->position.x, clickEvent->position.y });
+                for (size_t i = 0; i < iconButtons.size(); i++) {
+                    if (iconButtons[i].rectangle && iconButtons[i].rectangle->getGlobalBounds().contains(mousePos)) {
+                        if (i == 0) startPressed = true;
+                        else if (i == 1) optionsPressed = true;  // Add this
+                        else if (i == 2) highScorePressed = true;
+                        else if (i == 3) exitPressed = true;
+                    }
+                }
+            }
+        }
+    }
+    
+    void update(sf::Time dt) {}
+
+    void render(sf::RenderTarget& target) {
+        std::uint64_t selection = 0;
+        for (size_t i = 0; i < iconButtons.size(); i++) if (iconButtons[i].isSelected) selection |= 1ull << i;
+        layer.render(target, selection, [this](sf::RenderTarget& t, const sf::RenderStates& states) { drawLayer(t, states); });
+    }
+	// Background, buttons and selection outline (cached)
+    void drawLayer(sf::RenderTarget& target, const sf::RenderStates& states) {
+        if (menuBackground) target.draw(*menuBackground, states);
+        for (auto& btn : iconButtons) {
+            if (btn.rectangle) {
+                target.draw(*btn.rectangle, states);
+                if (btn.isSelected) {
+                    sf::FloatRect rectBounds = btn.rectangle->getGlobalBounds();
+                    sf::RectangleShape highlight(rectBounds.size);
+                    highlight.setPosition(rectBounds.position);
+                    highlight.setFillColor(sf::Color::Transparent);
+                    highlight.setOutlineColor(sf::Color::White);
+                    highlight.setOutlineThickness(3.f);
+                    target.draw(highlight, states);
+                }
+            }
+        }
+    }
+
+    bool isStartPressed() const { return startPressed; }
+    bool isHighScorePressed() const { return highScorePressed; }
+    bool isOptionsPressed() const { return optionsPressed; }
+    bool isExitPressed() const { return exitPressed; }
+    
+    void reset() { 
+        startPressed = exitPressed = highScorePressed = optionsPressed = false;
+        selectedIconIndex = 0; 
+    }
+};
+
+// ============================================================================
+// PAUSE MENU
+// ============================================================================
+struct PauseMenuButton {
+    sf::RectangleShape shape;
+    sf::Text* text = nullptr;
+    bool isHovered = false;
+    int action = 0; // 0=NONE, 1=CONTINUE, 2=TOGGLE_MUSIC, 3=EXIT_GAME
+};
+
+struct PauseMenu {
+    enum Action { NONE = 0, CONTINUE = 1, TOGGLE_MUSIC = 2, EXIT_GAME = 3 };
+	// Pause menu attributes
+    FontHandle font;
+    sf::Text* titleText = nullptr;
+    std::vector<PauseMenuButton> buttons;
+    sf::RectangleShape pauseBar1, pauseBar2;
+    sf::FloatRect pauseIconBounds;
+    int selectedIndex = 0;
+    bool isPaused_ = false;
+    bool musicOn = true;
+    Action lastAction = NONE;
+    float iconPulseTimer = 0.f;
+    float iconAlpha = 200.f;
+    CachedLayer layer;  // Overlay, title and buttons; the pulsing icon is drawn live
+	// Constructor
+    PauseMenu() {
+        float barWidth = 12.f, barHeight = 35.f, barSpacing = 8.f, iconX = 1140.f, iconY = 20.f;
+        pauseBar1.setSize({ barWidth, barHeight });
+        pauseBar1.setFillColor(sf::Color(255, 255, 255, 200));
+        pauseBar1.setPosition({ iconX, iconY });
+        pauseBar2.setSize({ barWidth, barHeight });
+        pauseBar2.setFillColor(sf::Color(255, 255, 255, 200));
+        pauseBar2.setPosition({ iconX + barWidth + barSpacing, iconY });
+        pauseIconBounds = sf::FloatRect({ iconX - 5.f, iconY - 5.f }, { (barWidth * 2) + barSpacing + 10.f, barHeight + 10.f });
+    }
+	// Destructor
+    ~PauseMenu() {
+        if (titleText) delete titleText;
+        for (auto& btn : buttons) if (btn.text) delete btn.text;
+    }
+	// Load pause menu assets
+    bool loadAssets(FontHandle f) {
+        font = std::move(f);
+        titleText = new sf::Text(*font, "GAME PAUSED", 60);
+        titleText->setFillColor(sf::Color::White);
+        titleText->setOutlineColor(sf::Color::Black);
+        titleText->setOutlineThickness(3.f);
+        sf::FloatRect titleBounds = titleText->getLocalBounds();
+        titleText->setOrigin({ titleBounds.size.x / 2.f, titleBounds.size.y / 2.f });
+        titleText->setPosition({ 600.f, 200.f });
+		// Define buttons
+        std::vector<std::pair<std::string, Action>> buttonData = { {"CONTINUE", CONTINUE}, {"MUSIC: ON", TOGGLE_MUSIC}, {"EXIT GAME", EXIT_GAME} };
+        float buttonWidth = 300.f, buttonHeight = 60.f, startY = 350.f, spacing = 80.f;
+		// Create buttons
+        for (size_t i = 0; i < buttonData.size(); i++) {
+            PauseMenuButton btn;
+            btn.shape.setSize({ buttonWidth, buttonHeight });
+            btn.shape.setFillColor(sf::Color(0, 0, 0, 100));
+            btn.shape.setOutlineColor(sf::Color(255, 255, 255, 150));
+            btn.shape.setOutlineThickness(2.f);
+            btn.shape.setOrigin({ buttonWidth / 2.f, buttonHeight / 2.f });
+            btn.shape.setPosition({ 600.f, startY + (i * spacing) });
+            btn.text = new sf::Text(*font, buttonData[i].first, 28);
+            btn.text->setFillColor(sf::Color::White);
+            sf::FloatRect textBounds = btn.text->getLocalBounds();
+            btn.text->setOrigin({ textBounds.size.x / 2.f, textBounds.size.y / 2.f });
+            btn.text->setPosition({ 600.f, startY + (i * spacing) - 5.f });
+            btn.action = buttonData[i].second;
+            buttons.push_back(btn);
+        }
+        return true;
+    }
+	// Handle input for pause menu
+    void handleInput(const sf::Event& event, const sf::RenderWindow& window) {
+        if (!isPaused_) {
+            if (const auto* clickEvent = event.getIf<sf::Event::MouseButtonPressed>()) {
+                if (clickEvent->button == sf::Mouse::Button::Left) {
+                    sf::Vector2f mousePos = window.mapPixelToCoords({ clickEvent->position.x, clickEvent->position.y });
+                    if (pauseIconBounds.contains(mousePos)) isPaused_ = true;
+                }
+            }
+            if (const auto* keyEvent = event.getIf<sf::Event::KeyPressed>()) {
+                if (keyEvent->code == sf::Keyboard::Key::Escape || keyEvent->code == sf::Keyboard::Key::P) isPaused_ = true;
+            }
+            return;
+        }
+		// Handle pause menu keyboard input
+        if (const auto* keyEvent = event.getIf<sf::Event::KeyPressed>()) {
+            if (keyEvent->code == sf::Keyboard::Key::Up) {
+                selectedIndex = (selectedIndex - 1 + static_cast<int>(buttons.size())) % static_cast<int>(buttons.size());
+            } else if (keyEvent->code == sf::Keyboard::Key::Down) {
+                selectedIndex = (selectedIndex + 1) % static_cast<int>(buttons.size());
+            } else if (keyEvent->code == sf::Keyboard::Key::Enter) {
+                lastAction = static_cast<Action>(buttons[selectedIndex].action);
+                if (lastAction == TOGGLE_MUSIC) {
+                    musicOn = !musicOn;
+                    buttons[selectedIndex].text->setString(musicOn ? "MUSIC: ON" : "MUSIC: OFF");
+                } else if (lastAction == CONTINUE) {
+                    isPaused_ = false;
+                }
+            } else if (keyEvent->code == sf::Keyboard::Key::Escape) {
+                isPaused_ = false;
+                lastAction = CONTINUE;
+            }
+        }
+		// Handle pause menu mouse movement
+        if (const auto* clickEvent = event.getIf<sf::Event::MouseButtonPressed>()) {
+            if (clickEvent->button == sf::Mouse::Button::Left) {
+                sf::Vector2f mousePos = window.mapPixelToCoords({ clickEvent->position.x, clickEvent->position.y });
+                for (size_t i = 0; i < buttons.size(); i++) {
+                    if (buttons[i].shape.getGlobalBounds().contains(mousePos)) {
+                        lastAction = static_cast<Action>(buttons[i].action);
+                        if (lastAction == TOGGLE_MUSIC) {
+                            musicOn = !musicOn;
+                            buttons[i].text->setString(musicOn ? "MUSIC: ON" : "MUSIC: OFF");
+                        } else if (lastAction == CONTINUE) {
+                            isPaused_ = false;
+                        }
+                    }
+                }
+            }
+        }
+    }
+	// Update pause menu state
+    void update(sf::Time dt) {
+        iconPulseTimer += dt.asSeconds();
+        iconAlpha = 180.f + 40.f * std::sin(iconPulseTimer * 3.f);
+        sf::Color iconColor(255, 255, 255, static_cast<std::uint8_t>(iconAlpha));
+        pauseBar1.setFillColor(iconColor);
+        pauseBar2.setFillColor(iconColor);
+		// Update button hover states
+        for (size_t i = 0; i < buttons.size(); i++) {
+            buttons[i].isHovered = (static_cast<int>(i) == selectedIndex);
+            if (buttons[i].isHovered) {
+                buttons[i].shape.setFillColor(sf::Color(50, 50, 80, 180));
+                buttons[i].shape.setOutlineColor(sf::Color::White);
+            } else {
+                buttons[i].shape.setFillColor(sf::Color(0, 0, 0, 100));
+                buttons[i].shape.setOutlineColor(sf::Color(255, 255, 255, 150));
+            }
+        }
+    }
+	// Render pause icon
+    void renderIcon(sf::RenderTarget& target) { target.draw(pauseBar1); target.draw(pauseBar2); }
+	// Render pause menu
+    void renderMenu(sf::RenderTarget& target) {
+        std::uint64_t key = static_cast<std::uint64_t>(selectedIndex) | (static_cast<std::uint64_t>(musicOn) << 8);
+        layer.render(target, key, [this](sf::RenderTarget& t, const sf::RenderStates& states) {
+            sf::RectangleShape overlay({ Playfield::width, Playfield::height });
+            overlay.setFillColor(sf::Color(0, 0, 0, 150));
+            t.draw(overlay, states);
+            if (titleText) t.draw(*titleText, states);
+            for (auto& btn : buttons) { t.draw(btn.shape, states); if (btn.text) t.draw(*btn.text, states); }
+        });
+    }
+	// Getters and setters
+    bool isPaused() const { return isPaused_; }
+    void setPaused(bool p) { isPaused_ = p; }
+    Action getLastAction() { return lastAction; }
+    void resetAction() { lastAction = NONE; }
+    bool isMusicOn() const { return musicOn; }
+};
+
+// ============================================================================
+// GAME OVER
+// ============================================================================
+struct GameOver {
+	// Animation clip and time since the screen was reset
+    const AnimationClip* clip = nullptr;
+    sf::Sprite* animSprite = nullptr;
+    float duration = 0.1f;
+    float elapsedTime = 0.f;
+    Menu menu;
+    bool showMenu = false;
+	// Destructor
+    ~GameOver() { if (animSprite) delete animSprite; }
+	// Initialize game over menu (textures are attached with setAssets)
+    void init(float frameDuration) {
+        duration = frameDuration;
+        menu.loadAssets(nullptr);
+        reset();
+    }
+	// Attach animation clip and background while the screen is resident
+    void setAssets(const AnimationClip& c, const sf::Texture& gameOverBg) {
+        clip = &c;
+        if (animSprite) { delete animSprite; animSprite = nullptr; }
+        if (!clip->empty()) {
+            animSprite = new sf::Sprite(*clip->frames[0].texture);
+            animSprite->setScale({ 2.5f, 2.5f });
+            sf::FloatRect bounds = animSprite->getLocalBounds();
+            animSprite->setOrigin({ bounds.size.x / 2.f, bounds.size.y / 2.f });
+            animSprite->setPosition({ 600.f, 450.f });
+        }
+        menu.setBackground(&gameOverBg);
+    }
+	// Drop texture references so the cache can evict them
+    void releaseAssets() {
+        if (animSprite) { delete animSprite; animSprite = nullptr; }
+        clip = nullptr;
+        menu.setBackground(nullptr);
+    }
+	// Reset game over state
+    void reset() {
+        showMenu = false;
+        elapsedTime = 0.f;
+        menu.reset();
+    }
+	// Handle input for game over menu
+    void handleInput(const sf::Event& event, const sf::RenderWindow& window) {
+        if (showMenu) menu.handleInput(event, window);
+    }
+	// Update game over animation and menu
+    void update(sf::Time dt) {
+        if (!showMenu) {
+            elapsedTime += dt.asSeconds();
+            showMenu = !clip || !animSprite || clip->isFinished(elapsedTime);
+        }
+        menu.update(dt);
+    }
+	// Render game over animation or menu
+    void render(sf::RenderTarget& window) {
+        if (!showMenu && animSprite) {
+            clip->apply(*animSprite, elapsedTime);
+            window.draw(*animSprite);
+        }
+        else menu.render(window);
+    }
+	// Getters for menu actions
+    bool isRetryPressed() const { return menu.isStartPressed(); }
+    bool isOptionsPressed() const { return menu.isOptionsPressed(); }
+    bool isHighScorePressed() const { return menu.isHighScorePressed(); }
+    bool isExitPressed() const { return menu.isExitPressed(); }
+};
+
+// ============================================================================
+// OPTIONS MENU
+// ============================================================================
+struct OptionsMenu {
+	// Background
+    FontHandle font;
+    sf::Sprite* background = nullptr;
+    TextureHandle optionsBgTex;
+
+    // Buttons
+    std::vector<sf::RectangleShape> buttons;
+    std::vector<sf::Text*> buttonTexts;
+    int selectedIndex = 0;
+
+    // Music state
+    bool musicOn = true;
+
+    // Image display
+    bool showingImage = false;
+    int currentImageIndex = -1;
+    TextureHandle image1Tex, image2Tex;
+    sf::Sprite* imageSprite = nullptr;
+
+    // Actions
+    bool backPressed = false;
+    CachedLayer layer;
+	// Destructor
+    ~OptionsMenu() {
+        if (background) delete background;
+        if (imageSprite) delete imageSprite;
+        for (auto* text : buttonTexts) if (text) delete text;
+    }
+	// Load options menu assets
+    bool loadAssets(FontHandle f) {
+        font = std::move(f);
+
+        // Create 3 buttons only: Music Toggle, Controls, Credits
+        std::vector<std::string> labels = { "MUSIC: ON", "CONTROLS", "CREDITS" };
+        float buttonWidth = 300.f, buttonHeight = 60.f;
+        float startY = 350.f, spacing = 100.f;
+		// Create buttons and texts
+        for (size_t i = 0; i < labels.size(); i++) {
+            sf::RectangleShape btn({ buttonWidth, buttonHeight });
+            btn.setFillColor(sf::Color::Transparent);  // Fully transparent
+            btn.setOutlineColor(sf::Color(255, 255, 255, 150));
+            btn.setOutlineThickness(2.f);
+            btn.setOrigin({ buttonWidth / 2.f, buttonHeight / 2.f });
+            btn.setPosition({ 600.f, startY + (i * spacing) });
+            buttons.push_back(btn);
+			// Create button text
+            sf::Text* text = new sf::Text(*font, labels[i], 28);
+            text->setFillColor(sf::Color::White);
+            sf::FloatRect textBounds = text->getLocalBounds();
+            text->setOrigin({ textBounds.size.x / 2.f, textBounds.size.y / 2.f });
+            text->setPosition({ 600.f, startY + (i * spacing) - 5.f });
+            buttonTexts.push_back(text);
+        }
+
+        return true;
+    }
+	// Load background and overlay images while the options screen is resident
+    void acquireAssets(ResourceCache& resources) {
+        // Load options background from file
+        optionsBgTex = resources.tryTexture("assests/textures/menu/options.png");
+        if (!optionsBgTex) {
+            // Fallback: create a dark background if file not found
+            sf::Image img;
+            img.resize(Playfield::size(), sf::Color(20, 20, 40));
+            optionsBgTex = resources.textureFromImage(img);
+        }
+		// Create background sprite
+        if (background) delete background;
+        background = new sf::Sprite(*optionsBgTex);
+        background->setScale({
+            Playfield::width / static_cast<float>(optionsBgTex->getSize().x),
+            Playfield::height / static_cast<float>(optionsBgTex->getSize().y)
+        });
+
+        layer.invalidate();
+
+        // Load images for controls and credits
+        image1Tex = resources.tryTexture("assests/textures/menu/controls.png");
+        if (!image1Tex) {
+            sf::Image img;
+            img.resize({ 800, 600 }, sf::Color(50, 50, 100));
+            image1Tex = resources.textureFromImage(img);
+        }
+        image2Tex = resources.tryTexture("assests/textures/menu/credits.png");
+        if (!image2Tex) {
+            sf::Image img;
+            img.resize({ 800, 600 }, sf::Color(100, 50, 50));
+            image2Tex = resources.textureFromImage(img);
+        }
+    }
+	// Drop texture references so the cache can evict them
+    void releaseAssets() {
+        reset();
+        if (background) { delete background; background = nullptr; }
+        optionsBgTex = image1Tex = image2Tex = nullptr;
+        layer.release();
+    }
+	// Handle input for options menu
+    void handleInput(const sf::Event& event, const sf::RenderWindow& window) {
+        // If showing an image, ESC closes it
+        if (showingImage) {
+            if (const auto* keyEvent = event.getIf<sf::Event::KeyPressed>()) {
+                if (keyEvent->code == sf::Keyboard::Key::Escape) {
+                    showingImage = false;
+                    currentImageIndex = -1;
+                    if (imageSprite) {
+                        delete imageSprite;
+                        imageSprite = nullptr;
+                    }
+                }
+            }
+            return;
+        }
+
+        // Keyboard navigation
+        if (const auto* keyEvent = event.getIf<sf::Event::KeyPressed>()) {
+            if (keyEvent->code == sf::Keyboard::Key::Up) {
+                selectedIndex = (selectedIndex - 1 + static_cast<int>(buttons.size())) % static_cast<int>(buttons.size());
+            }
+            else if (keyEvent->code == sf::Keyboard::Key::Down) {
+                selectedIndex = (selectedIndex + 1) % static_cast<int>(buttons.size());
+            }
+            else if (keyEvent->code == sf::Keyboard::Key::Enter) {
+                executeAction(selectedIndex);
+            }
+            else if (keyEvent->code == sf::Keyboard::Key::Escape) {
+                backPressed = true;  // ESC goes back to menu
+            }
+        }
+
+        // Mouse hover
+        if (const auto* moveEvent = event.getIf<sf::Event::MouseMoved>()) {
+            sf::Vector2f mousePos = window.mapPixelToCoords({ moveEvent->position.x, moveEvent->position.y });
+            for (size_t i = 0; i < buttons.size(); i++) {
+                if (buttons[i].getGlobalBounds().contains(mousePos)) {
+                    selectedIndex = static_cast<int>(i);
+                }
+            }
+        }
+
+        // Mouse click
+        if (const auto* clickEvent = event.getIf<sf::Event::MouseButtonPressed>()) {
+            if (clickEvent->button == sf::Mouse::Button::Left) {
+                sf::Vector2f mousePos = window.mapPixelToCoords({ clickEvent->position.x, clickEvent->position.y });
+                for (size_t i = 0; i < buttons.size(); i++) {
+                    if (buttons[i].getGlobalBounds().contains(mousePos)) {
+                        executeAction(static_cast<int>(i));
+                    }
+                }
+            }
+        }
+    }
+	// Execute action based on selected button
+    void executeAction(int index) {
+        switch (index) {
+        case 0:  // Toggle Music
+            musicOn = !musicOn;
+            buttonTexts[0]->setString(musicOn ? "MUSIC: ON" : "MUSIC: OFF");
+            {
+                sf::FloatRect textBounds = buttonTexts[0]->getLocalBounds();
+                buttonTexts[0]->setOrigin({ textBounds.size.x / 2.f, textBounds.size.y / 2.f });
+            }
+            break;
+        case 1:  // Show Controls image
+            showImage(0);
+            break;
+        case 2:  // Show Credits image
+            showImage(1);
+            break;
+        }
+    }
+	// Show image overlay
+    void showImage(int imageIndex) {
+        currentImageIndex = imageIndex;
+        showingImage = true;
+		// Create sprite for the image
+        if (imageSprite) delete imageSprite;
+
+        const sf::Texture& tex = (imageIndex == 0) ? *image1Tex : *image2Tex;
+        imageSprite = new sf::Sprite(tex);
+		// Center the image
+        sf::FloatRect bounds = imageSprite->getLocalBounds();
+        imageSprite->setOrigin({ bounds.size.x / 2.f, bounds.size.y / 2.f });
+        imageSprite->setPosition({ 600.f, 450.f });
+
+        // Scale to fit screen
+        float scaleX = Playfield::width / bounds.size.x;
+        float scaleY = Playfield::height / bounds.size.y;
+        float scale = std::min(scaleX, scaleY);
+        imageSprite->setScale({ scale, scale });
+    }
+	// Update options menu state
+    void update(sf::Time dt) {
+        for (size_t i = 0; i < buttons.size(); i++) {
+            if (static_cast<int>(i) == selectedIndex) {
+                buttons[i].setFillColor(sf::Color(255, 255, 255, 30));  // Slight highlight when selected
+                buttons[i].setOutlineColor(sf::Color::White);
+            }
+            else {
+                buttons[i].setFillColor(sf::Color::Transparent);
+                buttons[i].setOutlineColor(sf::Color(255, 255, 255, 150));
+            }
+        }
+    }
+	// Render options menu
+    void render(sf::RenderTarget& target) {
+        std::uint64_t key = static_cast<std::uint64_t>(selectedIndex) | (static_cast<std::uint64_t>(musicOn) << 8)
+            | (static_cast<std::uint64_t>(showingImage) << 9) | (static_cast<std::uint64_t>(currentImageIndex + 1) << 10);
+        layer.render(target, key, [this](sf::RenderTarget& t, const sf::RenderStates& states) { drawLayer(t, states); });
+    }
+	// Background, buttons, hints and the image overlay (cached)
+    void drawLayer(sf::RenderTarget& target, const sf::RenderStates& states) {
+        if (background) target.draw(*background, states);
+
+        // Draw buttons
+        for (size_t i = 0; i < buttons.size(); i++) {
+            target.draw(buttons[i], states);
+            if (buttonTexts[i]) target.draw(*buttonTexts[i], states);
+        }
+
+        // Draw hint text
+        sf::Text hint(*font, "Press ESC to go back", 20);
+        hint.setFillColor(sf::Color(200, 200, 200));
+        hint.setPosition({ 50.f, 850.f });
+        target.draw(hint, states);
+
+        // If showing an image, draw overlay and image
+        if (showingImage && imageSprite) {
+            sf::RectangleShape overlay({ Playfield::width, Playfield::height });
+            overlay.setFillColor(sf::Color(0, 0, 0, 200));
+            target.draw(overlay, states);
+
+            target.draw(*imageSprite, states);
+
+            sf::Text closeHint(*font, "Press ESC to close", 24);
+            closeHint.setFillColor(sf::Color::White);
+            sf::FloatRect hintBounds = closeHint.getLocalBounds();
+            closeHint.setOrigin({ hintBounds.size.x / 2.f, hintBounds.size.y / 2.f });
+            closeHint.setPosition({ 600.f, 850.f });
+            target.draw(closeHint, states);
+        }
+    }
+	// Getters
+    bool isBackPressed() const { return backPressed; }
+    bool isMusicOn() const { return musicOn; }
+	// Reset options menu state
+    void reset() {
+        backPressed = false;
+        selectedIndex = 0;
+        showingImage = false;
+        currentImageIndex = -1;
+        if (imageSprite) {
+            delete imageSprite;
+            imageSprite = nullptr;
+        }
+    }
+};
+
+// ============================================================================
+// ALLOCATION TRACKER
+// ============================================================================
+// Counts heap allocations per subsystem tag. The global operator new in
+// main.cpp reports every allocation here; the game loop brackets each phase
+// of a frame with a Scope so the count lands on the right tag. Worker threads
+// never set a tag and are counted as background. An instance turns the global
+// counters into per-frame figures and, when enforcing, fails the run on the
+// first steady-state frame that allocates on the game thread. Only background
+// threads and the F3 stats overlay (a debug view that rebuilds its text twice
+// a second) are left out of the check.
+struct AllocationTracker {
+    enum Tag : std::uint8_t { OTHER, EVENTS, SIMULATION, RENDER, OVERLAY, PRESENT, BACKGROUND, TAG_COUNT };
+    static constexpr const char* tagNames[TAG_COUNT] = { "other", "events", "sim", "render", "overlay", "present", "background" };
+    static constexpr int warmupFrames = 300;  // Steady frames before the check starts
+
+    static inline std::atomic<std::uint64_t> allocations[TAG_COUNT]{}, bytes[TAG_COUNT]{};
+    static inline std::atomic<std::uint64_t> exemptAllocations{ 0 };
+    static inline thread_local Tag current = BACKGROUND;
+    static inline thread_local int exemptDepth = 0;
+
+	// Called from operator new; must not allocate
+    static void record(std::size_t size) {
+        allocations[current].fetch_add(1, std::memory_order_relaxed);
+        bytes[current].fetch_add(size, std::memory_order_relaxed);
+        if (exemptDepth) exemptAllocations.fetch_add(1, std::memory_order_relaxed);
+    }
+	// Attribute allocations on this thread to a tag until the scope ends
+    struct Scope {
+        Tag previous;
+        explicit Scope(Tag tag) : previous(current) { current = tag; }
+        ~Scope() { current = previous; }
+    };
+	// One-off allocations the steady-state check should let through (boss spawn, prefetch, hotkeys)
+    struct Exempt {
+        Exempt() { exemptDepth++; }
+        ~Exempt() { exemptDepth--; }
+    };
+
+	// Per-frame figures
+    std::uint64_t lastAllocations[TAG_COUNT]{}, lastBytes[TAG_COUNT]{}, lastExempt = 0;
+    std::uint64_t frameAllocations[TAG_COUNT]{}, frameBytes[TAG_COUNT]{}, frameExempt = 0;
+    std::uint64_t frames = 0, totalAllocations = 0, worstFrame = 0;
+	// Steady-state enforcement
+    bool enforce = false, failed = false;
+    int steadyFrames = 0;
+    std::string failure;
+
+	// Close a frame; steady frames are checked once warmed up
+    void endFrame(bool steady) {
+        std::uint64_t total = 0;
+        for (int t = 0; t < TAG_COUNT; t++) {
+            std::uint64_t count = allocations[t].load(std::memory_order_relaxed), size = bytes[t].load(std::memory_order_relaxed);
+            frameAllocations[t] = count - lastAllocations[t]; frameBytes[t] = size - lastBytes[t];
+            lastAllocations[t] = count; lastBytes[t] = size;
+            if (t != BACKGROUND) total += frameAllocations[t];
+        }
+        std::uint64_t exempt = exemptAllocations.load(std::memory_order_relaxed);
+        frameExempt = exempt - lastExempt;
+        lastExempt = exempt;
+        frames++;
+        totalAllocations += total;
+        worstFrame = std::max(worstFrame, total);
+        steadyFrames = steady ? steadyFrames + 1 : 0;
+        std::uint64_t checked = 0;
+        for (int t = 0; t < BACKGROUND; t++) if (t != OVERLAY) checked += frameAllocations[t];
+        if (enforce && !failed && steadyFrames > warmupFrames && checked > frameExempt) {
+            failed = true;
+            std::ostringstream out;
+            out << "Allocation check failed on steady PLAYING frame " << frames << ":";
+            for (int t = 0; t < BACKGROUND; t++)
+                if (t != OVERLAY && frameAllocations[t]) out << " " << tagNames[t] << " " << frameAllocations[t] << " (" << frameBytes[t] << " B),";
+            out << " exempt " << frameExempt;
+            failure = out.str();
+        }
+    }
+	// Last frame per tag, for the overlay
+    std::string summary() const {
+        std::ostringstream out;
+        out << "alloc/frame";
+        bool any = false;
+        for (int t = 0; t < BACKGROUND; t++) {
+            if (!frameAllocations[t]) continue;
+            out << "  " << tagNames[t] << " " << frameAllocations[t] << " (" << frameBytes[t] << " B)";
+            any = true;
+        }
+        if (!any) out << " 0";
+        return out.str();
+    }
+	// Whole-run totals, for benchmark output
+    std::string report() const {
+        std::ostringstream out;
+        out << std::fixed << std::setprecision(2) << "allocations: " << totalAllocations << " over " << frames << " frames ("
+            << (frames ? static_cast<double>(totalAllocations) / frames : 0.0) << "/frame, worst " << worstFrame << ")";
+        for (int t = 0; t < TAG_COUNT; t++)
+            out << "\n  " << std::setw(10) << tagNames[t] << " " << allocations[t].load() << " (" << bytes[t].load() << " B)";
+        return out.str();
+    }
+};
+
+// ============================================================================
+// FRAME PACER
+// ============================================================================
+struct FramePacer {
+    enum Mode { CAPPED = 0, VSYNC = 1, UNCAPPED = 2 };
+    using Clock = std::chrono::steady_clock;
+	// Pacing settings
+    Mode mode = CAPPED;
+    double targetFps = 144.0;
+    double spinMargin = 0.002;      // Seconds before the deadline to stop sleeping and spin
+    double oversleepEstimate = 0.001;  // Running estimate of how late sleep_until wakes up
+    Clock::time_point deadline = Clock::now();
+    Clock::time_point lastFrameEnd = Clock::now();
+	// Statistics over the most recent frames
+    static constexpr std::size_t historySize = 1024;
+    std::vector<float> frameTimes = std::vector<float>(historySize, 0.f);  // Milliseconds
+    std::size_t frameIndex = 0, frameCount = 0;
+    std::uint64_t missedDeadlines = 0, totalFrames = 0;
+
+	// Switch pacing mode (vsync is handled by the driver)
+    void setMode(Mode m, sf::Window& window) {
+        mode = m;
+        window.setFramerateLimit(0);
+        window.setVerticalSyncEnabled(mode == VSYNC);
+        deadline = lastFrameEnd = Clock::now();
+        resetStats();
+    }
+    void cycleMode(sf::Window& window) { setMode(static_cast<Mode>((mode + 1) % 3), window); }
+    const char* getModeName() const { return mode == CAPPED ? "CAPPED" : mode == VSYNC ? "VSYNC" : "UNCAPPED"; }
+
+	// Wait for the next frame deadline and record the frame time
+    void endFrame() {
+        bool behind = false;
+        if (mode == CAPPED) {
+            auto period = std::chrono::duration_cast<Clock::duration>(std::chrono::duration<double>(1.0 / targetFps));
+            deadline += period;
+            auto now = Clock::now();
+            // Fell more than a frame behind: count the miss against the original deadline,
+            // then restart the schedule instead of bursting
+            if (now > deadline + period) {
+                missedDeadlines++;
+                deadline = now;
+                behind = true;
+            }
+            // Coarse sleep, leaving a margin that adapts to how late the OS wakes us
+            auto sleepUntil = deadline - std::chrono::duration_cast<Clock::duration>(std::chrono::duration<double>(spinMargin));
+            if (now < sleepUntil) {
+                std::this_thread::sleep_until(sleepUntil);
+                double late = std::chrono::duration<double>(Clock::now() - sleepUntil).count();
+                oversleepEstimate = oversleepEstimate * 0.9 + std::max(0.0, late) * 0.1;
+                spinMargin = std::min(0.004, std::max(0.0005, oversleepEstimate * 2.0));
+            }
+            // Spin the remainder for a precise wake-up
+            while (Clock::now() < deadline) std::this_thread::yield();
+        }
+        auto end = Clock::now();
+        float frameMs = std::chrono::duration<float, std::milli>(end - lastFrameEnd).count();
+        lastFrameEnd = end;
+        if (mode == CAPPED && !behind && end - deadline > std::chrono::microseconds(500)) missedDeadlines++;
+        frameTimes[frameIndex] = frameMs;
+        frameIndex = (frameIndex + 1) % historySize;
+        frameCount = std::min(frameCount + 1, historySize);
+        totalFrames++;
+    }
+
+	// Frame time percentile in milliseconds (p in 0..1)
+    float percentile(float p) const {
+        if (frameCount == 0) return 0.f;
+        std::vector<float> sorted(frameTimes.begin(), frameTimes.begin() + frameCount);
+        std::size_t k = std::min(frameCount - 1, static_cast<std::size_t>(p * (frameCount - 1) + 0.5f));
+        std::nth_element(sorted.begin(), sorted.begin() + k, sorted.end());
+        return sorted[k];
+    }
+	// Standard deviation of recent frame times in milliseconds
+    float jitter() const {
+        if (frameCount < 2) return 0.f;
+        double sum = 0.0, sumSq = 0.0;
+        for (std::size_t i = 0; i < frameCount; i++) { sum += frameTimes[i]; sumSq += frameTimes[i] * frameTimes[i]; }
+        double mean = sum / frameCount;
+        return static_cast<float>(std::sqrt(std::max(0.0, sumSq / frameCount - mean * mean)));
+    }
+	// One-line summary for overlays and logs
+    std::string summary() const {
+        std::ostringstream out;
+        out << std::fixed << std::setprecision(2) << getModeName()
+            << "  p50 " << percentile(0.5f) << "ms  p95 " << percentile(0.95f) << "ms  p99 " << percentile(0.99f)
+            << "ms  jitter " << jitter() << "ms  missed " << missedDeadlines << "/" << totalFrames;
+        return out.str();
+    }
+    void resetStats() {
+        frameIndex = frameCount = 0;
+        missedDeadlines = totalFrames = 0;
+    }
+	// Idle frame that blocked on input: restart the schedule without recording it
+    void skipFrame() { deadline = lastFrameEnd = Clock::now(); }
+};
+
+// ============================================================================
+// SPAWN GOVERNOR
+// ============================================================================
+struct SpawnGovernor {
+	// Budget for simulation + render work, as a fraction of the frame period
+    float budgetFraction = 0.75f;
+    float smoothedCostMs = 0.f;
+    float pressure = 0.f;         // 0 = full detail, 1 = maximum throttling
+    float rampUpRate = 2.f;       // Pressure gained per second at 100% overload
+    float recoverRate = 0.25f;    // Pressure shed per second with headroom
+	// Limits at zero and at full pressure
+    int maxEnemiesRelaxed = 60, maxEnemiesThrottled = 15;
+    int maxDronesRelaxed = static_cast<int>(SwarmDrones::maxDrones), maxDronesThrottled = 120;
+    int maxAsteroidsRelaxed = 8, maxAsteroidsThrottled = 2;
+    int maxExplosionsRelaxed = 64, maxExplosionsThrottled = 6;
+
+	// Feed the measured cost of the last frame
+    void update(sf::Time simTime, sf::Time renderTime, double targetFps, sf::Time dt) {
+        float costMs = (simTime + renderTime).asSeconds() * 1000.f;
+        smoothedCostMs = smoothedCostMs * 0.9f + costMs * 0.1f;
+        float budgetMs = static_cast<float>(1000.0 / targetFps) * budgetFraction;
+        float seconds = std::min(dt.asSeconds(), 0.1f);
+        if (smoothedCostMs > budgetMs) {
+            float overload = (smoothedCostMs - budgetMs) / budgetMs;
+            pressure += rampUpRate * std::min(overload, 1.f) * seconds;
+        }
+        else if (smoothedCostMs < budgetMs * 0.8f) {
+            // Hysteresis band between 80% and 100% of the budget holds the level
+            pressure -= recoverRate * seconds;
+        }
+        pressure = std::max(0.f, std::min(pressure, 1.f));
+    }
+
+	// Spawn rate multiplier (1 = normal)
+    float spawnRateScale() const { return 1.f - 0.6f * pressure; }
+	// Live entity caps
+    std::size_t maxEnemies() const { return lerpCap(maxEnemiesRelaxed, maxEnemiesThrottled); }
+    std::size_t maxDrones() const { return lerpCap(maxDronesRelaxed, maxDronesThrottled); }
+    std::size_t maxAsteroids() const { return lerpCap(maxAsteroidsRelaxed, maxAsteroidsThrottled); }
+    std::size_t maxExplosions() const { return lerpCap(maxExplosionsRelaxed, maxExplosionsThrottled); }
+	// Cosmetic effects fade out first
+    float shakeScale() const { return std::max(0.f, 1.f - 2.f * pressure); }
+    std::string summary() const {
+        std::ostringstream out;
+        out << std::fixed << std::setprecision(2) << "cost " << smoothedCostMs << "ms  pressure " << pressure;
+        return out.str();
+    }
+
+    std::size_t lerpCap(int relaxed, int throttled) const {
+        return static_cast<std::size_t>(std::lround(relaxed + (throttled - relaxed) * pressure));
+    }
+};
+
+// ============================================================================
+// IMPACT EFFECTS
+// ============================================================================
+// Hit effects under heavy fire. An impact landing within mergeRadius of an
+// explosion of the same clip that started less than mergeWindow ago feeds that
+// explosion, which grows, instead of stacking an identical copy on top of it.
+// New explosions are limited per frame, and once the global cap is full an
+// impact can only take the place of a less important explosion. Each sound
+// plays at most once a frame and only the strongest shake of a frame applies.
+struct ImpactEffects {
+	// Importance of an impact when the budgets are tight
+    enum Priority { HIT = 0, KILL = 1, MAJOR = 2 };
+    float mergeRadius = 40.f, mergeWindow = 0.1f;
+    float growth = 0.2f, maxStrength = 2.f;   // Strength added per merged impact, and its ceiling
+    int maxNewPerFrame = 6;                   // MAJOR impacts are exempt
+	// This frame
+    int spawnedThisFrame = 0;
+    float shakeAmount = 0.f, shakeDuration = 0.f;
+    const sf::Sound* playedSounds[4] = {};
+    int playedCount = 0;
+	// Totals for the run
+    int spawned = 0, merged = 0, dropped = 0, replaced = 0;
+
+	// Open the next frame's budgets
+    void beginFrame() {
+        spawnedThisFrame = 0;
+        shakeAmount = shakeDuration = 0.f;
+        playedCount = 0;
+    }
+    void reset() {
+        beginFrame();
+        spawned = merged = dropped = replaced = 0;
+    }
+	// Add an impact's explosion, merged or budgeted; returns false if it was dropped
+    bool add(std::vector<Explosion>& explosions, std::size_t cap, const AnimationLibrary& animations,
+             AnimationLibrary::Id clip, float x, float y, Priority priority, float now) {
+        if (animations[clip].empty()) return false;
+		// Explosions are kept in start order, so recent ones are a short scan from the back
+        for (std::size_t i = explosions.size(); i-- > 0 && now - explosions[i].startTime <= mergeWindow;) {
+            Explosion& e = explosions[i];
+            sf::Vector2f d = e.sprite.getPosition() - sf::Vector2f(x, y);
+            if (e.clip != clip || d.x * d.x + d.y * d.y > mergeRadius * mergeRadius) continue;
+            e.setStrength(std::min(e.strength + growth, maxStrength));
+            e.priority = std::max(e.priority, static_cast<int>(priority));
+            merged++;
+            return true;
+        }
+        if (spawnedThisFrame >= maxNewPerFrame && priority < MAJOR) { dropped++; return false; }
+		// At the cap, replace the oldest explosion of lower priority
+        if (explosions.size() >= cap) {
+            auto victim = std::find_if(explosions.begin(), explosions.end(), [priority](const Explosion& e) { return e.priority < priority; });
+            if (victim == explosions.end()) { dropped++; return false; }
+            explosions.erase(victim);
+            replaced++;
+        }
+        explosions.emplace_back(animations, clip, x, y, now);
+        explosions.back().priority = priority;
+        spawnedThisFrame++; spawned++;
+        return true;
+    }
+	// Whether a sound may (re)start this frame
+    bool claimSound(const sf::Sound& sound) {
+        for (int i = 0; i < playedCount; i++) if (playedSounds[i] == &sound) return false;
+        if (playedCount < 4) playedSounds[playedCount++] = &sound;
+        return true;
+    }
+	// Keep the strongest shake requested this frame, with its own duration (longer one on a tie)
+    void requestShake(float amount, float duration) {
+        if (amount < shakeAmount || (amount == shakeAmount && duration <= shakeDuration)) return;
+        shakeAmount = amount;
+        shakeDuration = duration;
+    }
+    std::string summary() const {
+        std::ostringstream out;
+        out << "fx " << spawned << " merged " << merged << " dropped " << dropped << " replaced " << replaced;
+        return out.str();
+    }
+};
+
+// ============================================================================
+// RESOLUTION SCALER
+// ============================================================================
+// The scene is drawn in logical 1200x900 coordinates into an offscreen texture
+// at scale x logical pixels, then upscaled into the window (letterboxed). The
+// scale follows the full frame time against the frame period, which includes
+// GPU time whether it shows up in display() or as a missed vsync. While frames
+// run late it steps down; a step that does not make frames faster means the
+// CPU is the limit, so it is undone and lowering pauses for a while. After a
+// stretch of on-time frames it probes back up toward the window's native
+// resolution. The texture is sized once for the native scale; lower scales
+// only use its top-left part.
+struct ResolutionScaler {
+    sf::RenderTexture* scene = nullptr;
+    sf::Sprite* sceneSprite = nullptr;
+    float scale = 1.f;             // Render pixels per logical unit
+    float minScale = 0.5f, maxScale = 1.f;
+    float step = 0.05f;
+    float lateFraction = 1.1f;     // Frames slower than this many periods count as late
+    float averageFrameMs = 0.f;    // Mean over the last decision window
+    float windowMs = 0.f;          // Frame time summed since the last decision
+    int windowFrames = 0;
+    float adjustTimer = 0.f;
+	// Step checking and probing
+    bool checkingStep = false;     // Last change was a step down still to be judged
+    bool probing = false;          // Last change was a step up still to be judged
+    float frameMsBeforeStep = 0.f;
+    float holdTimer = 0.f;         // No stepping down while > 0 (CPU bound)
+    float onTimeSeconds = 0.f;
+    float probeDelay = 2.f;        // On-time seconds before trying a higher scale; doubles on failure
+
+    ~ResolutionScaler() {
+        if (sceneSprite) delete sceneSprite;
+        if (scene) delete scene;
+    }
+	// Size the scene texture for the window's native resolution
+    bool resize(sf::Vector2u windowSize) {
+        maxScale = std::max(minScale, std::min(windowSize.x / Playfield::width, windowSize.y / Playfield::height));
+        scale = std::min(scale, maxScale);
+        sf::Vector2u textureSize = pixelSize(maxScale);
+        if (scene && scene->getSize() == textureSize) return true;
+        if (!scene) scene = new sf::RenderTexture();
+        if (!scene->resize(textureSize)) return false;
+        scene->setSmooth(true);
+        if (sceneSprite) delete sceneSprite;
+        sceneSprite = new sf::Sprite(scene->getTexture());
+        return true;
+    }
+    sf::Vector2u pixelSize(float s) const {
+        return { static_cast<unsigned>(std::lround(Playfield::width * s)), static_cast<unsigned>(std::lround(Playfield::height * s)) };
+    }
+	// Logical view that renders into the scaled part of the scene texture
+    sf::View view() const {
+        sf::View v(sf::FloatRect({ 0.f, 0.f }, { Playfield::width, Playfield::height }));
+        sf::Vector2u used = pixelSize(scale), total = scene->getSize();
+        v.setViewport(sf::FloatRect({ 0.f, 0.f }, { static_cast<float>(used.x) / total.x, static_cast<float>(used.y) / total.y }));
+        return v;
+    }
+	// Logical view of the whole window, with bars keeping the 4:3 aspect
+    static sf::View letterboxView(sf::Vector2u windowSize) {
+        sf::View v(sf::FloatRect({ 0.f, 0.f }, { Playfield::width, Playfield::height }));
+        float windowRatio = static_cast<float>(windowSize.x) / static_cast<float>(std::max(1u, windowSize.y));
+        float ratio = Playfield::width / Playfield::height;
+        if (windowRatio > ratio) v.setViewport(sf::FloatRect({ (1.f - ratio / windowRatio) / 2.f, 0.f }, { ratio / windowRatio, 1.f }));
+        else v.setViewport(sf::FloatRect({ 0.f, (1.f - windowRatio / ratio) / 2.f }, { 1.f, windowRatio / ratio }));
+        return v;
+    }
+	// Upscale the finished scene into the window
+    void present(sf::RenderWindow& window) {
+        scene->display();
+        sf::Vector2u used = pixelSize(scale);
+        sceneSprite->setTextureRect(sf::IntRect({ 0, 0 }, { static_cast<int>(used.x), static_cast<int>(used.y) }));
+        sceneSprite->setScale({ Playfield::width / used.x, Playfield::height / used.y });
+        window.setView(letterboxView(window.getSize()));
+        window.clear();
+        window.draw(*sceneSprite);
+    }
+	// Feed the full time of the last frame (start to start, not including an idle wait)
+    void update(sf::Time frameTime, double targetFps, sf::Time dt) {
+        windowMs += frameTime.asSeconds() * 1000.f;
+        windowFrames++;
+        holdTimer = std::max(0.f, holdTimer - dt.asSeconds());
+        adjustTimer += dt.asSeconds();
+        if (adjustTimer < 0.25f) return;
+		// Each window holds only frames drawn at the current scale, so steps compare cleanly
+        float elapsed = adjustTimer;
+        averageFrameMs = windowMs / windowFrames;
+        adjustTimer = windowMs = 0.f;
+        windowFrames = 0;
+        bool late = averageFrameMs > static_cast<float>(1000.0 / targetFps) * lateFraction;
+		// A step down that did not speed frames up: the CPU is the limit, undo it and hold
+        if (checkingStep) {
+            checkingStep = false;
+            if (averageFrameMs > frameMsBeforeStep * 0.97f) {
+                scale = std::min(maxScale, scale + step);
+                holdTimer = 10.f;
+                onTimeSeconds = 0.f;
+                return;
+            }
+        }
+		// A step up that made frames late: back off and wait longer before the next probe
+        if (probing) {
+            probing = false;
+            if (late) {
+                scale = std::max(minScale, scale - step);
+                probeDelay = std::min(probeDelay * 2.f, 16.f);
+                onTimeSeconds = 0.f;
+                return;
+            }
+        }
+        if (late) {
+            onTimeSeconds = 0.f;
+            if (holdTimer <= 0.f && scale > minScale) {
+                frameMsBeforeStep = averageFrameMs;
+                scale = std::max(minScale, scale - step);
+                checkingStep = true;
+            }
+        }
+        else if (scale < maxScale && (onTimeSeconds += elapsed) >= probeDelay) {
+            scale = std::min(maxScale, scale + step);
+            probing = true;
+            onTimeSeconds = 0.f;
+        }
+    }
+    std::string summary() const {
+        sf::Vector2u used = pixelSize(scale);
+        std::ostringstream out;
+        out << "res " << used.x << "x" << used.y << (holdTimer > 0.f ? " (cpu bound)" : "");
+        return out.str();
+    }
+};
+
+// ============================================================================
+// SIMULATION RANDOM
+// ============================================================================
+// Gameplay RNG with copyable state (xorshift32), so snapshots restore the
+// same future spawns and drops. Cosmetic effects keep using rand().
+struct SimRandom {
+    std::uint32_t state = 0x9E3779B9u;
+
+    void seed(std::uint32_t s) { state = s ? s : 0x9E3779B9u; }
+    std::uint32_t next() {
+        state ^= state << 13;
+        state ^= state >> 17;
+        state ^= state << 5;
+        return state;
+    }
+	// Uniform integer in [0, n)
+    int nextInt(int n) { return n > 0 ? static_cast<int>(next() % static_cast<std::uint32_t>(n)) : 0; }
+};
+
+// ============================================================================
+// ENEMY BEHAVIOURS
+// ============================================================================
+// Enemy types written as small bytecode programs instead of C++. Timed
+// instructions (move, sine, wait) hold an enemy for a while; the others take
+// effect at once and fall through to the next instruction. Programs come from
+// the built-in sources below and from text files in assests/behaviours/
+// (one program per *.bhv file, named after the file):
+//
+//     # comment
+//     hp 90                  starting and maximum HP
+//     label top              jump target
+//     move 0 120 1.5         velocity x y, for seconds (0 = forever)
+//     sine 100 0.5 4         sweep amplitude and frequency while sinking, for seconds
+//     wait 0.5               hold still for seconds
+//     fire spread            one volley of a named pattern
+//     autofire aimed 1 2     keep firing every 1-2 seconds ("autofire none" stops)
+//     ifhp 50 rage           jump when HP is below 50%
+//     jump top
+struct BehaviourOp {
+    enum Code : std::uint8_t { MOVE, SINE, WAIT, FIRE, AUTOFIRE, IF_HP_BELOW, JUMP, CODE_COUNT };
+    Code code = WAIT;
+    std::uint8_t pattern = 0;  // FIRE, AUTOFIRE
+    std::uint16_t target = 0;  // IF_HP_BELOW, JUMP
+    float a = 0.f, b = 0.f;    // Operands
+    float duration = 0.f;      // Timed instructions, 0 = forever
+
+    bool isTimed() const { return code <= WAIT; }
+};
+
+struct BehaviourProgram {
+    std::string name;
+    int hp = 70;
+    std::vector<BehaviourOp> ops;
+};
+
+// Patterns a program can fire, by name
+struct NamedPattern { const char* name; PatternRef pattern; };
+inline constexpr NamedPattern behaviourPatterns[] = {
+    { "none", {} },
+    { "down", BulletPatterns::ref(BulletPatterns::singleDown) },
+    { "spread", BulletPatterns::ref(BulletPatterns::classicSpread) },
+    { "wave", BulletPatterns::ref(BulletPatterns::swayingWave) },
+    { "aimed", BulletPatterns::ref(BulletPatterns::aimedSingle) },
+    { "aimed3", BulletPatterns::ref(BulletPatterns::aimedTriple) },
+    { "spiral", BulletPatterns::ref(BulletPatterns::fourArmSpiral) },
+    { "ring", BulletPatterns::ref(BulletPatterns::burstRing) },
+};
+
+// Programs that ship with the game
+inline constexpr const char* builtInBehaviours[][2] = {
+    { "diver", R"(# Drops in fast, stalls for an aimed burst, then dives through
+hp 60
+move 0 220 1.2
+wait 0.4
+fire aimed3
+wait 0.4
+move 0 320 0
+)" },
+    { "strafer", R"(# Wide sweeps with steady fire, frantic below half HP
+hp 110
+autofire down 1.5 3
+label sweep
+sine 160 0.8 3
+ifhp 50 berserk
+jump sweep
+label berserk
+autofire spread 0.6 1
+move 0 40 0
+)" },
+};
+
+struct BehaviourLibrary {
+    std::vector<BehaviourProgram> programs;  // Sorted by name, so indices don't depend on directory order
+    std::uint64_t signature = 0;             // Hash of every program; snapshots only load into the same set
+
+	// Compile the built-in programs, then any *.bhv files in a directory
+    void load(const std::string& directory) {
+        for (const auto& source : builtInBehaviours) compile(source[0], source[1]);
+        std::error_code error;
+        for (const auto& entry : std::filesystem::directory_iterator(directory, error)) {
+            if (entry.path().extension() != ".bhv") continue;
+            std::ifstream file(entry.path());
+            std::stringstream source;
+            source << file.rdbuf();
+            compile(entry.path().stem().string(), source.str());
+        }
+        std::sort(programs.begin(), programs.end(), [](const BehaviourProgram& l, const BehaviourProgram& r) { return l.name < r.name; });
+        signature = hashPrograms();
+    }
+
+	// FNV-1a over names, HP and every instruction field (not the struct bytes, which have padding)
+    std::uint64_t hashPrograms() const {
+        std::uint64_t hash = 14695981039346656037ull;
+        auto mix = [&hash](const void* data, std::size_t size) {
+            for (std::size_t i = 0; i < size; i++) { hash ^= static_cast<const std::uint8_t*>(data)[i]; hash *= 1099511628211ull; }
+        };
+        for (const BehaviourProgram& program : programs) {
+            mix(program.name.c_str(), program.name.size() + 1);
+            mix(&program.hp, sizeof(program.hp));
+            for (const BehaviourOp& op : program.ops) {
+                mix(&op.code, sizeof(op.code)); mix(&op.pattern, sizeof(op.pattern)); mix(&op.target, sizeof(op.target));
+                mix(&op.a, sizeof(op.a)); mix(&op.b, sizeof(op.b)); mix(&op.duration, sizeof(op.duration));
+            }
+        }
+        return hash;
+    }
+
+	// Compile one program, replacing any of the same name; false (and a message) on errors
+    bool compile(const std::string& name, const std::string& source) {
+        BehaviourProgram program;
+        program.name = name;
+        std::map<std::string, int> labels;
+        std::vector<std::pair<std::size_t, std::string>> jumps;  // Resolved once all labels are known
+        std::istringstream lines(source);
+        std::string line;
+        int lineNumber = 0;
+        auto fail = [&](const std::string& why) {
+            std::cerr << "Behaviour " << name << " line " << lineNumber << ": " << why << "\n";
+            return false;
+        };
+        while (std::getline(lines, line)) {
+            lineNumber++;
+            std::istringstream in(line.substr(0, line.find('#')));
+            std::string word;
+            if (!(in >> word)) continue;
+            BehaviourOp op;
+            if (word == "hp") {
+                if (!(in >> program.hp) || program.hp <= 0) return fail("hp needs a positive value");
+                continue;
+            }
+            if (word == "label") {
+                std::string label;
+                if (!(in >> label)) return fail("label needs a name");
+                labels[label] = static_cast<int>(program.ops.size());
+                continue;
+            }
+            if (word == "move") { op.code = BehaviourOp::MOVE; in >> op.a >> op.b >> op.duration; }
+            else if (word == "sine") { op.code = BehaviourOp::SINE; in >> op.a >> op.b >> op.duration; }
+            else if (word == "wait") { op.code = BehaviourOp::WAIT; in >> op.duration; }
+            else if (word == "fire" || word == "autofire") {
+                op.code = word == "fire" ? BehaviourOp::FIRE : BehaviourOp::AUTOFIRE;
+                std::string pattern;
+                in >> pattern;
+                int id = patternId(pattern);
+                if (id < 0) return fail("unknown pattern '" + pattern + "'");
+                op.pattern = static_cast<std::uint8_t>(id);
+                if (op.code == BehaviourOp::AUTOFIRE && id != 0) in >> op.a >> op.b;
+            }
+            else if (word == "ifhp" || word == "jump") {
+                op.code = word == "ifhp" ? BehaviourOp::IF_HP_BELOW : BehaviourOp::JUMP;
+                if (op.code == BehaviourOp::IF_HP_BELOW) in >> op.a;
+                std::string label;
+                in >> label;
+                jumps.push_back({ program.ops.size(), label });
+            }
+            else return fail("unknown instruction '" + word + "'");
+            if (in.fail()) return fail("missing operands for " + word);
+            program.ops.push_back(op);
+        }
+        for (const auto& [index, label] : jumps) {
+            auto it = labels.find(label);
+            if (it == labels.end()) return fail("unknown label '" + label + "'");
+            program.ops[index].target = static_cast<std::uint16_t>(it->second);
+        }
+        auto existing = std::find_if(programs.begin(), programs.end(), [&](const BehaviourProgram& p) { return p.name == name; });
+        if (existing != programs.end()) *existing = std::move(program);
+        else programs.push_back(std::move(program));
+        return true;
+    }
+
+    static int patternId(const std::string& name) {
+        for (int i = 0; i < static_cast<int>(std::size(behaviourPatterns)); i++) if (name == behaviourPatterns[i].name) return i;
+        return -1;
+    }
+	// Instruction an enemy is at; past the end it sinks off the screen
+    const BehaviourOp& opAt(const Enemy& e) const {
+        static constexpr BehaviourOp finished{ BehaviourOp::MOVE, 0, 0, 0.f, 50.f, 0.f };
+        const std::vector<BehaviourOp>& ops = programs[e.behaviour].ops;
+        return e.pc < ops.size() ? ops[e.pc] : finished;
+    }
+};
+
+// Runs every scripted enemy. Enemies are bucketed by the opcode they are at
+// and each bucket runs as one straight-line loop over gathered arrays, so a
+// frame costs a few loops per opcode instead of a dispatch per enemy.
+struct BehaviourVM {
+    static constexpr int maxSteps = 8;         // Instant instructions an enemy may run per frame
+    static constexpr float bulletSpeed = 400.f;
+    std::array<std::vector<std::uint32_t>, BehaviourOp::CODE_COUNT> batches;
+    std::vector<std::uint32_t> active, pending;
+    std::vector<float> x, y, a, b, timer;      // Gathered per batch
+
+    void reserve(std::size_t n) {
+        for (auto& batch : batches) batch.reserve(n);
+        for (auto* v : { &active, &pending }) v->reserve(n);
+        for (auto* v : { &x, &y, &a, &b, &timer }) v->reserve(n);
+    }
+
+    void step(std::vector<Enemy>& enemies, const BehaviourLibrary& library, float dt, float playfieldWidth, sf::Vector2f target,
+              SimRandom& rng, TimerWheel& timers, std::vector<Bullet>& bullets, const sf::Texture& bulletTex) {
+        active.clear();
+        for (std::size_t i = 0; i < enemies.size(); i++) if (enemies[i].behaviour >= 0) active.push_back(static_cast<std::uint32_t>(i));
+        auto fire = [&](Enemy& e, int pattern) {
+            sf::Vector2f spawn = e.getPosition();
+            fireVolley(behaviourPatterns[pattern].pattern, e.volleyIndex++, spawn, target, bulletSpeed, bullets, bulletTex);
+        };
+		// Instant instructions fall through, so run passes until every enemy reached a timed one
+        for (int pass = 0; pass < maxSteps && !active.empty(); pass++) {
+            for (auto& batch : batches) batch.clear();
+            for (std::uint32_t i : active) batches[library.opAt(enemies[i]).code].push_back(i);
+            pending.clear();
+			// Timed instructions
+            runBatch(enemies, library, batches[BehaviourOp::MOVE], dt, [&](std::size_t k) {
+                x[k] += a[k] * dt;
+                y[k] += b[k] * dt;
+            }, playfieldWidth);
+            runBatch(enemies, library, batches[BehaviourOp::SINE], dt, [&](std::size_t k) {
+                x[k] = enemies[batches[BehaviourOp::SINE][k]].startX + fastSin(timer[k] * b[k]) * a[k];
+                y[k] += enemies[batches[BehaviourOp::SINE][k]].speed * dt;
+            }, playfieldWidth);
+            runBatch(enemies, library, batches[BehaviourOp::WAIT], dt, [](std::size_t) {}, playfieldWidth);
+			// Instant instructions
+            for (std::uint32_t i : batches[BehaviourOp::FIRE]) {
+                fire(enemies[i], library.opAt(enemies[i]).pattern);
+                advance(enemies[i], enemies[i].pc + 1);
+            }
+            for (std::uint32_t i : batches[BehaviourOp::AUTOFIRE]) {
+                Enemy& e = enemies[i];
+                const BehaviourOp& op = library.opAt(e);
+                e.autofireOp = op.pattern ? static_cast<int>(e.pc) : -1;
+                timers.cancel(e.shot);
+                if (op.pattern) e.shot = timers.schedule(rollCooldown(op, rng), TimerWheel::ENEMY_FIRE, e.id);
+                advance(e, e.pc + 1);
+            }
+            for (std::uint32_t i : batches[BehaviourOp::IF_HP_BELOW]) {
+                Enemy& e = enemies[i];
+                const BehaviourOp& op = library.opAt(e);
+                bool below = e.hp * 100.f < op.a * library.programs[e.behaviour].hp;
+                advance(e, below ? op.target : e.pc + 1);
+            }
+            for (std::uint32_t i : batches[BehaviourOp::JUMP]) advance(enemies[i], library.opAt(enemies[i]).target);
+            for (int code = BehaviourOp::FIRE; code < BehaviourOp::CODE_COUNT; code++)
+                pending.insert(pending.end(), batches[code].begin(), batches[code].end());
+            active.swap(pending);
+        }
+    }
+	// One volley of an enemy's autofire, when its ENEMY_FIRE timer came due; returns the delay to the next (0 = autofire is off)
+    static float autofire(Enemy& e, const BehaviourLibrary& library, sf::Vector2f target, SimRandom& rng,
+                          std::vector<Bullet>& bullets, const sf::Texture& bulletTex) {
+        if (e.behaviour < 0 || e.autofireOp < 0) return 0.f;
+        const BehaviourOp& op = library.programs[e.behaviour].ops[e.autofireOp];
+        fireVolley(behaviourPatterns[op.pattern].pattern, e.volleyIndex++, e.getPosition(), target, bulletSpeed, bullets, bulletTex);
+        return rollCooldown(op, rng);
+    }
+
+private:
+    static void advance(Enemy& e, std::uint32_t pc) { e.pc = pc; e.opTimer = 0.f; }
+    static float rollCooldown(const BehaviourOp& op, SimRandom& rng) { return op.a + (op.b - op.a) * static_cast<float>(rng.nextInt(1000)) / 1000.f; }
+
+	// Gather a timed batch, integrate it with fn, scatter and advance finished instructions
+    template <typename Fn>
+    void runBatch(std::vector<Enemy>& enemies, const BehaviourLibrary& library, const std::vector<std::uint32_t>& batch, float dt, Fn fn, float playfieldWidth) {
+        const std::size_t n = batch.size();
+        for (auto* v : { &x, &y, &a, &b, &timer }) v->resize(n);
+        for (std::size_t k = 0; k < n; k++) {
+            Enemy& e = enemies[batch[k]];
+            const BehaviourOp& op = library.opAt(e);
+            x[k] = e.getPosition().x; y[k] = e.getPosition().y;
+            a[k] = op.a; b[k] = op.b;
+            if (e.opTimer == 0.f) e.startX = x[k];  // Sweeps start from where the enemy is
+            timer[k] = e.opTimer += dt;
+        }
+        for (std::size_t k = 0; k < n; k++) fn(k);
+        for (std::size_t k = 0; k < n; k++) {
+            Enemy& e = enemies[batch[k]];
+            const BehaviourOp& op = library.opAt(e);
+            e.sprite.setPosition({ std::max(e.halfWidth, std::min(x[k], playfieldWidth - e.halfWidth)), y[k] });
+            if (op.duration > 0.f && e.opTimer >= op.duration) advance(e, e.pc + 1);
+        }
+    }
+};
+
+// ============================================================================
+// GAME SNAPSHOT
+// ============================================================================
+// Complete simulation state in one flat, trivially copyable block: saving is
+// a memcpy or a single fwrite, restoring rebuilds the entity vectors from it.
+struct GameSnapshot {
+    static constexpr std::uint32_t magic = 0x53534E50;  // "SSNP"
+    static constexpr std::uint32_t version = 13;
+    static constexpr int maxEnemies = 128, maxPlayerBullets = 512, maxEnemyBullets = 1024;
+    static constexpr int maxExplosions = 128, maxAsteroids = 32, maxPowerups = 64, maxMissiles = 256;
+    static constexpr int maxTimers = maxEnemies + 64;  // A shot timer per enemy, plus spawns, cooldowns and powerups
+    static constexpr int maxDrones = static_cast<int>(SwarmDrones::maxDrones);
+
+    struct PlayerState {
+        float x, y, rotationDeg, bankStart;
+        std::int32_t bankFrom, bankTarget, attackReady;
+        TimerWheel::Handle tripleShot, homing;
+    };
+    struct EnemyState {
+        float x, y, startX, sineTimer, shootCooldown, opTimer;
+        std::int32_t id, hp, textureIndex, behaviour, pc, autofireOp, volleyIndex;
+        TimerWheel::Handle shot;
+    };
+    struct DroneState { float x, y, velocityX, velocityY, slotX, slotY, age, diveAt; std::int32_t health; };
+    struct BulletState { float x, y, dirX, dirY, rotationDeg, speed, timeToLive; };
+    struct MissileState { float x, y, dirX, dirY, timeToLive; };
+    struct ExplosionState { float x, y, startTime, strength; std::int32_t clip, priority; };
+    struct AsteroidState { float x, y, rotationDeg; std::int32_t health; };
+    struct PowerupState { float x, y; std::int32_t type; };
+    struct BossState { float x, y, bulletSpeed; std::int32_t hp, maxHp, movingRight, volleyIndex; };
+    struct TimerState { std::uint32_t due, generation; std::int32_t pending, event, a, b; };
+
+    std::uint32_t header = magic, headerVersion = version;
+    std::uint64_t behaviourSignature;  // BehaviourLibrary::signature the program indices refer to
+	// Game counters and timers
+    std::uint32_t rngState;
+    std::int32_t score, hearts, enemiesDefeated, bossCount, nextBossScore, bossSpawned, nextEnemyId;
+    float runTime;
+    float shakeAmount, shakeDuration, shakeTimer, maxShakeDuration;
+    float backgroundY1, backgroundY2;
+    float powerupMessageTimer;
+    std::int32_t showPowerupMessage;
+    char powerupMessage[24];
+	// Entities
+    PlayerState player;
+    std::int32_t hasPlayer2;
+    PlayerState player2;
+    std::int32_t hasBoss;
+    BossState boss;
+    std::int32_t enemyCount, playerBulletCount, enemyBulletCount, explosionCount, asteroidCount, powerupCount, missileCount;
+    std::int32_t droneCount;
+    EnemyState enemies[maxEnemies];
+    DroneState drones[maxDrones];
+    BulletState playerBullets[maxPlayerBullets];
+    BulletState enemyBullets[maxEnemyBullets];
+    ExplosionState explosions[maxExplosions];
+    AsteroidState asteroids[maxAsteroids];
+    PowerupState powerups[maxPowerups];
+    MissileState missiles[maxMissiles];
+	// Timer wheel, pool slot by pool slot so saved handles stay valid
+    std::uint32_t timerTick;
+    float timerRemainder;
+    std::int32_t timerCount;
+    TimerState timers[maxTimers];
+
+	// Header, counts and enum fields in range; anything else is a truncated or foreign file
+    bool isValid() const {
+        if (header != magic || headerVersion != version) return false;
+        auto inRange = [](std::int32_t value, std::int32_t lo, std::int32_t hi) { return value >= lo && value <= hi; };
+        if (!inRange(enemyCount, 0, maxEnemies) || !inRange(playerBulletCount, 0, maxPlayerBullets)
+            || !inRange(enemyBulletCount, 0, maxEnemyBullets) || !inRange(explosionCount, 0, maxExplosions)
+            || !inRange(asteroidCount, 0, maxAsteroids) || !inRange(powerupCount, 0, maxPowerups)
+            || !inRange(missileCount, 0, maxMissiles) || !inRange(timerCount, 0, maxTimers)
+            || !inRange(droneCount, 0, maxDrones)) return false;
+        for (int i = 0; i < explosionCount; i++) {
+            if (!inRange(explosions[i].clip, 0, AnimationLibrary::CLIP_COUNT - 1)
+                || !inRange(explosions[i].priority, ImpactEffects::HIT, ImpactEffects::MAJOR)) return false;
+        }
+        for (int i = 0; i < powerupCount; i++)
+            if (!inRange(powerups[i].type, Powerup::SCORE_BONUS, Powerup::SMART_BOMB)) return false;
+        for (int i = 0; i < timerCount; i++)
+            if (!inRange(timers[i].event, TimerWheel::NONE, TimerWheel::ENEMY_FIRE)) return false;
+        return true;
+    }
+};
+static_assert(std::is_trivially_copyable<GameSnapshot>::value, "GameSnapshot must stay memcpy-able");
+
+// ============================================================================
+// NETPLAY
+// ============================================================================
+// Two-player co-op over UDP. Both peers run the same fixed-step simulation;
+// local input applies immediately and the remote input is predicted (last
+// known input repeated). When a real remote input disagrees, the game rolls
+// back to the snapshot of that frame and re-simulates up to the present.
+struct NetplaySession {
+    static constexpr std::uint32_t packetMagic = 0x53534E54;  // "SSNT"
+    static constexpr int historySize = 32;       // Frames of inputs and snapshots kept
+    static constexpr int maxRollback = 8;        // Stall rather than predict further ahead
+    static constexpr int inputsPerPacket = 16;   // Redundant, so a lost packet costs nothing
+    static constexpr float tickSeconds = 1.f / 144.f;
+    static constexpr float peerTimeout = 5.f;    // Seconds of silence before the peer counts as gone
+
+    struct Packet {
+        std::uint32_t magic, seed, firstFrame;
+        std::uint8_t count;
+        std::uint8_t inputs[inputsPerPacket];
+    };
+
+    sf::UdpSocket socket;
+    std::optional<sf::IpAddress> remoteAddress;
+    unsigned short remotePort = 0;
+    int localPlayer = 0;               // 0 hosts and picks the seed, 1 joins
+    std::uint32_t seed = 0;
+    bool seedKnown = false, peerSeen = false, started = false;
+    std::chrono::steady_clock::time_point lastHeard;  // Last valid packet from the peer
+
+    std::int64_t frame = 0;            // Next frame to simulate
+    std::int64_t confirmedFrame = -1;  // Remote inputs known up to here
+    std::int64_t rollbackFrame = -1;   // Earliest mispredicted frame, -1 if none
+    std::array<std::uint8_t, historySize> localInputs{}, remoteInputs{};
+    std::array<std::int64_t, historySize> remoteFrames{};  // Frame held by each slot
+    std::array<bool, historySize> remoteConfirmed{};
+    float accumulator = 0.f;
+
+	// Bind the local port and resolve the peer
+    bool start(unsigned short localPort, const std::string& host, unsigned short port, int player) {
+        localPlayer = player;
+        remoteAddress = sf::IpAddress::resolve(host);
+        remotePort = port;
+        if (!remoteAddress || socket.bind(localPort) != sf::Socket::Status::Done) return false;
+        socket.setBlocking(false);
+        seedKnown = localPlayer == 0;
+        if (seedKnown) seed = static_cast<std::uint32_t>(std::time(nullptr));
+        remoteFrames.fill(-1);
+        return true;
+    }
+    bool ready() const { return peerSeen && seedKnown; }
+	// The peer answered once and has been silent too long since (quit, crashed or unreachable)
+    bool peerLost() const {
+        return peerSeen && std::chrono::duration<float>(std::chrono::steady_clock::now() - lastHeard).count() > peerTimeout;
+    }
+	// Prediction window not yet exhausted
+    bool canAdvance() const { return frame - confirmedFrame <= maxRollback; }
+    int slot(std::int64_t f) const { return static_cast<int>(f % historySize); }
+
+	// Remote input for a frame: the confirmed one, or a prediction that is remembered for checking
+    std::uint8_t remoteInput(std::int64_t f) {
+        int s = slot(f);
+        if (remoteFrames[s] == f && remoteConfirmed[s]) return remoteInputs[s];
+        std::uint8_t predicted = confirmedFrame >= 0 ? remoteInputs[slot(confirmedFrame)] : 0;
+        remoteFrames[s] = f; remoteInputs[s] = predicted; remoteConfirmed[s] = false;
+        return predicted;
+    }
+
+	// Send the latest local inputs (an empty packet doubles as a handshake)
+    void send() {
+        Packet packet{};
+        packet.magic = packetMagic;
+        packet.seed = seed;
+        std::int64_t first = std::max<std::int64_t>(0, frame - inputsPerPacket);
+        packet.firstFrame = static_cast<std::uint32_t>(first);
+        packet.count = static_cast<std::uint8_t>(frame - first);
+        for (int i = 0; i < packet.count; i++) packet.inputs[i] = localInputs[slot(first + i)];
+        (void)socket.send(&packet, sizeof(packet), *remoteAddress, remotePort);
+    }
+
+	// Drain the socket, confirming remote inputs and flagging mispredictions
+    void receive() {
+        Packet packet;
+        std::size_t received = 0;
+        std::optional<sf::IpAddress> sender;
+        unsigned short senderPort = 0;
+        while (socket.receive(&packet, sizeof(packet), received, sender, senderPort) == sf::Socket::Status::Done) {
+            if (received != sizeof(packet) || packet.magic != packetMagic || packet.count > inputsPerPacket) continue;
+            peerSeen = true;
+            lastHeard = std::chrono::steady_clock::now();
+            if (!seedKnown) { seed = packet.seed; seedKnown = true; }
+            for (int i = 0; i < packet.count; i++) {
+                std::int64_t f = static_cast<std::int64_t>(packet.firstFrame) + i;
+                if (f <= confirmedFrame || f >= frame + historySize / 2) continue;
+                int s = slot(f);
+                if (f < frame && remoteFrames[s] == f && !remoteConfirmed[s] && remoteInputs[s] != packet.inputs[i])
+                    rollbackFrame = rollbackFrame < 0 ? f : std::min(rollbackFrame, f);
+                remoteFrames[s] = f; remoteInputs[s] = packet.inputs[i]; remoteConfirmed[s] = true;
+            }
+            while (remoteFrames[slot(confirmedFrame + 1)] == confirmedFrame + 1 && remoteConfirmed[slot(confirmedFrame + 1)])
+                confirmedFrame++;
+        }
+    }
+};
+
+// ============================================================================
+// LEADERBOARD
+// ============================================================================
+// Finished run, stored as-is in the leaderboard file
+struct RunRecord {
+    std::int32_t score = 0, enemiesDefeated = 0, bosses = 0;
+    float durationSeconds = 0.f;
+    std::int64_t finishedAt = 0;  // Unix time
+};
+static_assert(std::is_trivially_copyable<RunRecord>::value, "RunRecord is written as raw bytes");
+
+// Top runs, kept sorted by score. The game thread only touches the in-memory
+// list; a writer thread saves copies to disk (temp file + rename, so a crash
+// mid-write leaves the previous file intact).
+class Leaderboard {
+public:
+    static constexpr std::uint32_t magic = 0x53534C42;  // "SSLB"
+    static constexpr std::uint32_t version = 1;
+    static constexpr std::size_t capacity = 10;
+
+    explicit Leaderboard(const std::string& filePath) : path(filePath) {
+        load();
+        writer = std::thread([this] { writerLoop(); });
+    }
+	// Flushes the last pending write before returning
+    ~Leaderboard() {
+        {
+            std::lock_guard<std::mutex> lock(mutex);
+            stopping = true;
+        }
+        wake.notify_one();
+        writer.join();
+    }
+    Leaderboard(const Leaderboard&) = delete;
+    Leaderboard& operator=(const Leaderboard&) = delete;
+
+    const std::vector<RunRecord>& getEntries() const { return entries; }
+    int best() const { return entries.empty() ? 0 : entries.front().score; }
+
+	// Add a run; returns its rank (0 = best) or -1 if it did not place. Never blocks on disk
+    int submit(const RunRecord& run) {
+        auto pos = std::upper_bound(entries.begin(), entries.end(), run,
+            [](const RunRecord& a, const RunRecord& b) { return a.score > b.score; });
+        int rank = static_cast<int>(pos - entries.begin());
+        if (rank >= static_cast<int>(capacity)) return -1;
+        entries.insert(pos, run);
+        if (entries.size() > capacity) entries.pop_back();
+        {
+            std::lock_guard<std::mutex> lock(mutex);
+            pending = entries;  // Only the newest list matters
+        }
+        wake.notify_one();
+        return rank;
+    }
+	// Remove a run submitted earlier (a checkpoint retry replacing its own entry)
+    void withdraw(const RunRecord& run) {
+        auto pos = std::find_if(entries.begin(), entries.end(), [&run](const RunRecord& e) {
+            return e.score == run.score && e.finishedAt == run.finishedAt && e.enemiesDefeated == run.enemiesDefeated;
+        });
+        if (pos == entries.end()) return;
+        entries.erase(pos);
+        {
+            std::lock_guard<std::mutex> lock(mutex);
+            pending = entries;
+        }
+        wake.notify_one();
+    }
+
+private:
+    struct FileHeader { std::uint32_t magic, version, count; };
+
+    std::string path;
+    std::vector<RunRecord> entries;
+    std::optional<std::vector<RunRecord>> pending;
+    bool stopping = false;
+    std::mutex mutex;
+    std::condition_variable wake;
+    std::thread writer;
+
+	// Read the binary file, or import the old single-number highscore.txt
+    void load() {
+        std::ifstream file(path, std::ios::binary);
+        FileHeader header{};
+        if (file.read(reinterpret_cast<char*>(&header), sizeof(header)) && header.magic == magic && header.version == version) {
+            entries.resize(std::min<std::size_t>(header.count, capacity));
+            file.read(reinterpret_cast<char*>(entries.data()), static_cast<std::streamsize>(entries.size() * sizeof(RunRecord)));
+            if (!file) entries.clear();
+        }
+        else {
+            std::ifstream legacy("highscore.txt");
+            RunRecord run;
+            if (legacy >> run.score && run.score > 0) entries.push_back(run);
+        }
+        std::sort(entries.begin(), entries.end(), [](const RunRecord& a, const RunRecord& b) { return a.score > b.score; });
+    }
+	// Save queued lists until asked to stop
+    void writerLoop() {
+        std::unique_lock<std::mutex> lock(mutex);
+        while (true) {
+            wake.wait(lock, [this] { return stopping || pending.has_value(); });
+            if (pending) {
+                std::vector<RunRecord> snapshot = std::move(*pending);
+                pending.reset();
+                lock.unlock();
+                write(snapshot);
+                lock.lock();
+            }
+            else if (stopping) return;
+        }
+    }
+	// Write-then-rename: readers see either the old file or the complete new one. The temp file
+	// is synced to disk before the rename, so a power loss cannot leave a renamed empty file
+    bool write(const std::vector<RunRecord>& list) const {
+        std::string tempPath = path + ".tmp";
+        std::FILE* file = std::fopen(tempPath.c_str(), "wb");
+        if (!file) return false;
+        FileHeader header{ magic, version, static_cast<std::uint32_t>(list.size()) };
+        bool ok = std::fwrite(&header, sizeof(header), 1, file) == 1
+            && std::fwrite(list.data(), sizeof(RunRecord), list.size(), file) == list.size()
+            && std::fflush(file) == 0 && syncFile(file);
+        ok = std::fclose(file) == 0 && ok;
+        if (!ok) return false;
+        std::error_code error;
+        std::filesystem::rename(tempPath, path, error);
+        if (error) return false;
+        syncDirectory();
+        return true;
+    }
+    static bool syncFile(std::FILE* file) {
+#ifdef _WIN32
+        return _commit(_fileno(file)) == 0;
+#else
+        return fsync(fileno(file)) == 0;
+#endif
+    }
+	// Make the rename itself durable (POSIX only; Windows commits it with the file)
+    void syncDirectory() const {
+#ifndef _WIN32
+        std::filesystem::path parent = std::filesystem::path(path).parent_path();
+        int dir = open(parent.empty() ? "." : parent.c_str(), O_RDONLY);
+        if (dir < 0) return;
+        fsync(dir);
+        close(dir);
+#endif
+    }
+};
+
+// ============================================================================
+// TELEMETRY
+// ============================================================================
+// Gameplay event log. The game thread pushes fixed-size events into a
+// lock-free single-producer/single-consumer ring (a few stores, no locks, no
+// allocation); a background thread drains it to a binary file. If the ring is
+// ever full, events are counted as dropped instead of blocking the frame.
+class Telemetry {
+public:
+    enum EventType : std::uint16_t {
+        DAMAGE_TAKEN, ENEMY_KILLED, ASTEROID_DESTROYED, POWERUP_COLLECTED,
+        BOSS_SPAWNED, BOSS_DEFEATED, RUN_ENDED, SAMPLE, EVENTS_DROPPED
+    };
+	// One record; entity counts show what was on screen at that moment
+    struct Event {
+        float time;             // Seconds into the run
+        std::int32_t value;     // Points, hearts, powerup type, boss HP... (depends on type)
+        float x, y;
+        std::uint16_t type;
+        std::uint16_t enemies, asteroids, powerups, enemyBullets, playerBullets;
+    };
+    static_assert(std::is_trivially_copyable<Event>::value, "Events are written as raw bytes");
+
+    static constexpr std::uint32_t magic = 0x5353544C;  // "SSTL"
+    static constexpr std::uint32_t version = 1;
+    static constexpr std::size_t capacity = 4096;      // Power of two
+
+    explicit Telemetry(const std::string& path) : file(path, std::ios::binary | std::ios::trunc) {
+        std::uint32_t header[2] = { magic, version };
+        file.write(reinterpret_cast<const char*>(header), sizeof(header));
+        drainer = std::thread([this] { drainLoop(); });
+    }
+    ~Telemetry() {
+        running.store(false);
+        drainer.join();
+        drain();
+    }
+    Telemetry(const Telemetry&) = delete;
+    Telemetry& operator=(const Telemetry&) = delete;
+
+	// Producer side, game thread only
+    void record(const Event& event) {
+        std::size_t h = head.load(std::memory_order_relaxed);
+        if (h - tail.load(std::memory_order_acquire) >= capacity) {
+            dropped.fetch_add(1, std::memory_order_relaxed);
+            return;
+        }
+        ring[h & (capacity - 1)] = event;
+        head.store(h + 1, std::memory_order_release);
+    }
+
+	// Print a log file as text (used by --decode-telemetry)
+    static bool decode(const std::string& path, std::ostream& out) {
+        static const char* names[] = { "DAMAGE_TAKEN", "ENEMY_KILLED", "ASTEROID_DESTROYED", "POWERUP_COLLECTED",
+            "BOSS_SPAWNED", "BOSS_DEFEATED", "RUN_ENDED", "SAMPLE", "EVENTS_DROPPED" };
+        std::ifstream in(path, std::ios::binary);
+        std::uint32_t header[2] = {};
+        if (!in.read(reinterpret_cast<char*>(header), sizeof(header)) || header[0] != magic || header[1] != version) {
+            out << path << ": not a telemetry log" << std::endl;
+            return false;
+        }
+        Event e;
+        while (in.read(reinterpret_cast<char*>(&e), sizeof(e))) {
+            const char* name = e.type < sizeof(names) / sizeof(names[0]) ? names[e.type] : "UNKNOWN";
+            out << std::fixed << std::setprecision(2) << std::setw(9) << e.time << "s  " << std::left << std::setw(20) << name << std::right
+                << " value " << std::setw(6) << e.value << "  at (" << std::setprecision(0) << e.x << ", " << e.y << ")"
+                << "  enemies " << e.enemies << "  asteroids " << e.asteroids << "  powerups " << e.powerups
+                << "  bullets " << e.enemyBullets << "/" << e.playerBullets << "\n";
+        }
+        return true;
+    }
+
+private:
+    std::vector<Event> ring = std::vector<Event>(capacity);
+    alignas(64) std::atomic<std::size_t> head{ 0 };  // Written by the game thread
+    alignas(64) std::atomic<std::size_t> tail{ 0 };  // Written by the drain thread
+    std::atomic<std::uint32_t> dropped{ 0 };
+    std::uint32_t droppedReported = 0;
+    std::atomic<bool> running{ true };
+    std::ofstream file;
+    std::thread drainer;
+
+    void drainLoop() {
+        while (running.load()) {
+            drain();
+            std::this_thread::sleep_for(std::chrono::milliseconds(50));
+        }
+    }
+	// Consumer side: copy everything published so far to the file
+    void drain() {
+        std::size_t t = tail.load(std::memory_order_relaxed);
+        std::size_t h = head.load(std::memory_order_acquire);
+        for (; t != h; t++) file.write(reinterpret_cast<const char*>(&ring[t & (capacity - 1)]), sizeof(Event));
+        tail.store(t, std::memory_order_release);
+        std::uint32_t lost = dropped.load(std::memory_order_relaxed);
+        if (lost != droppedReported) {
+            Event note{};
+            note.type = EVENTS_DROPPED;
+            note.value = static_cast<std::int32_t>(lost - droppedReported);
+            file.write(reinterpret_cast<const char*>(&note), sizeof(note));
+            droppedReported = lost;
+        }
+        file.flush();
+    }
+};
+
+// ============================================================================
+// OFFSCREEN RENDERER
+// ============================================================================
+// Headless backend: the game draws into a render texture instead of a window
+// and every frame is read back and written as a numbered PNG or raw RGBA file.
+// No window is opened and no audio plays. It is not display-free, though: SFML
+// draws only through an OpenGL context it creates via the platform window
+// system, so on Linux it still needs an X server. Use a virtual one (xvfb-run)
+// with a software driver (Mesa llvmpipe, LIBGL_ALWAYS_SOFTWARE=1) on machines
+// without a GPU or a monitor. A truly display-less context (OSMesa, EGL
+// surfaceless) would need a GL backend SFML does not provide.
+struct OffscreenRecorder {
+    enum Format { PNG, RAW };
+    sf::RenderTexture target;
+    std::string outputDir;
+    Format format = PNG;
+    int frameLimit = 0;
+    int frameIndex = 0;
+    int menuFrames = 30;          // Frames of main menu before the scripted start
+    sf::Time totalRenderTime;
+    std::string failedPath;       // First frame that could not be written; the run stops there
+
+    bool begin(const std::string& dir, int frames, Format f) {
+        outputDir = dir;
+        frameLimit = frames;
+        format = f;
+        std::error_code error;
+        std::filesystem::create_directories(outputDir, error);
+        return !error && target.resize(Playfield::size());
+    }
+    bool finished() const { return frameIndex >= frameLimit || !failedPath.empty(); }
+	// Finish the frame, read it back and write it out (renderTime excludes the readback)
+    bool capture(sf::Time renderTime) {
+        target.display();
+        totalRenderTime += renderTime;
+        sf::Image image = target.getTexture().copyToImage();
+        char name[32];
+        std::snprintf(name, sizeof(name), format == PNG ? "frame_%05d.png" : "frame_%05d.rgba", frameIndex++);
+        std::string path = outputDir + "/" + name;
+        bool written = false;
+        if (format == PNG) written = image.saveToFile(path);
+        else {
+            std::ofstream file(path, std::ios::binary);
+            file.write(reinterpret_cast<const char*>(image.getPixelsPtr()), static_cast<std::streamsize>(image.getSize().x) * image.getSize().y * 4);
+            written = static_cast<bool>(file);
+        }
+        if (!written && failedPath.empty()) failedPath = path;
+        return written;
+    }
+    std::string summary() const {
+        std::ostringstream out;
+        out << std::fixed << std::setprecision(3) << frameIndex << " frames written to " << outputDir
+            << ", render " << (frameIndex ? totalRenderTime.asSeconds() * 1000.f / frameIndex : 0.f) << "ms/frame";
+        return out.str();
+    }
+};
+
+// ============================================================================
+// VIDEO CAPTURE
+// ============================================================================
+// Records the window to a Y4M (or headerless I420) file without stalling the
+// frame. Each frame is copied on the GPU into a small ring of textures and read
+// back a few frames later, when the copy has long finished. Worker threads
+// convert to YUV and a writer thread appends frames in order. Memory is a fixed
+// pool of frame buffers; when all are busy the frame is dropped and counted.
+// Rendered frames are resampled to the declared frame rate: each is written once
+// per clock tick it stayed on screen, so idle waits and uncapped or vsync pacing
+// still play back at real speed.
+class VideoCapture {
+public:
+    enum Format { Y4M, RAW_I420 };
+    static constexpr int gpuSlots = 3;   // Readback trails the GPU copy by gpuSlots - 1 frames
+    static constexpr int poolSize = 8;   // Frames in flight between readback and disk
+
+    VideoCapture() = default;
+    VideoCapture(const VideoCapture&) = delete;
+    VideoCapture& operator=(const VideoCapture&) = delete;
+    ~VideoCapture() { stop(); }
+
+    bool isRecording() const { return recording; }
+
+	// Open the output and start the worker threads
+    bool start(const std::string& path, sf::Vector2u frameSize, int frameRate, Format f, int workerCount = 2) {
+        if (recording || frameSize.x % 2 || frameSize.y % 2 || frameRate <= 0) return false;
+        size = frameSize;
+        format = f;
+        fps = frameRate;
+        file.open(path, std::ios::binary | std::ios::trunc);
+        if (!file.is_open()) return false;
+        for (sf::Texture& texture : staging) {
+            if (!texture.resize(size)) { file.close(); return false; }
+        }
+        if (format == Y4M) file << "YUV4MPEG2 W" << size.x << " H" << size.y << " F" << fps << ":1 Ip A1:1 C420jpeg\n";
+        std::size_t pixels = static_cast<std::size_t>(size.x) * size.y;
+        pool.assign(poolSize, Frame{});
+        freeSlots.clear();
+        for (int i = 0; i < poolSize; i++) {
+            pool[i].rgba.resize(pixels * 4);
+            pool[i].yuv.resize(pixels * 3 / 2);
+            freeSlots.push_back(i);
+        }
+        convertQueue.clear();
+        gpuFrames = nextSequence = nextToWrite = clockFrames = 0;
+        captured = dropped = skipped = 0;
+        startTime = std::chrono::steady_clock::now();
+        written = 0;
+        stopping = false;
+        recording = true;
+        for (int i = 0; i < workerCount; i++) workers.emplace_back([this] { convertLoop(); });
+        writer = std::thread([this] { writeLoop(); });
+        return true;
+    }
+	// Finish queued frames and close the file
+    void stop() {
+        if (!recording) return;
+		// Frames still staged on the GPU are read back too, waiting for buffers instead of dropping
+        double now = secondsSinceStart();
+        for (std::int64_t j = std::max<std::int64_t>(0, gpuFrames - (gpuSlots - 1)); j < gpuFrames; j++)
+            readBackStaged(j, j + 1 < gpuFrames ? stagedAt[(j + 1) % gpuSlots] : now, true);
+        {
+            std::lock_guard<std::mutex> lock(mutex);
+            stopping = true;
+        }
+        changed.notify_all();
+        for (std::thread& worker : workers) worker.join();
+        workers.clear();
+        writer.join();
+        file.close();
+        recording = false;
+    }
+
+	// Game thread, before display(): GPU copy of this frame, readback of an older one
+    void captureFrame(const sf::Window& window) {
+        if (!recording) return;
+        double now = secondsSinceStart();
+		// The oldest staged frame stayed on screen until the one after it was staged
+        std::int64_t oldest = gpuFrames - (gpuSlots - 1);
+        if (oldest >= 0) readBackStaged(oldest, stagedAt[(oldest + 1) % gpuSlots], false);
+        staging[gpuFrames % gpuSlots].update(window);
+        stagedAt[gpuFrames % gpuSlots] = now;
+        gpuFrames++;
+    }
+
+    std::string summary() const {
+        std::ostringstream out;
+        out << "REC " << written.load() << " frames at " << fps << " fps from " << captured << " captured, "
+            << skipped << " resampled away, " << dropped << " dropped";
+        return out.str();
+    }
+
+private:
+    struct Frame {
+        std::vector<std::uint8_t> rgba, yuv;
+        std::int64_t sequence = 0;
+        int repeats = 1;               // Clock ticks this frame covers
+        bool converted = false;
+    };
+
+    sf::Vector2u size;
+    Format format = Y4M;
+    int fps = 60;                          // Declared in the header; output is resampled to it
+    std::ofstream file;
+    std::array<sf::Texture, gpuSlots> staging;
+    std::array<double, gpuSlots> stagedAt{};  // Seconds into the recording each staged frame was shown
+    std::int64_t gpuFrames = 0;
+    std::int64_t clockFrames = 0;          // Output frames accounted for so far
+    std::chrono::steady_clock::time_point startTime;
+    bool recording = false;
+
+    std::vector<Frame> pool;
+    std::vector<int> freeSlots;            // Guarded by mutex
+    std::vector<int> convertQueue;         // Guarded by mutex
+    std::int64_t nextSequence = 0;         // Game thread
+    std::int64_t nextToWrite = 0;          // Writer thread
+    std::uint64_t captured = 0, dropped = 0, skipped = 0;
+    std::atomic<std::uint64_t> written{ 0 };
+    bool stopping = false;
+    std::mutex mutex;
+    std::condition_variable changed;
+    std::vector<std::thread> workers;
+    std::thread writer;
+
+    double secondsSinceStart() const {
+        return std::chrono::duration<double>(std::chrono::steady_clock::now() - startTime).count();
+    }
+	// Read back staged frame j, on screen until endTime: it covers every clock tick up to there,
+	// none if a later frame replaced it within the same tick. A dropped frame leaves its ticks
+	// to the next one, so timing holds either way
+    void readBackStaged(std::int64_t j, double endTime, bool wait) {
+        std::int64_t due = static_cast<std::int64_t>(std::ceil(endTime * fps));
+        if (due <= clockFrames) { skipped++; return; }
+        if (readBack(staging[j % gpuSlots], static_cast<int>(due - clockFrames), wait)) clockFrames = due;
+    }
+	// Copy a finished GPU frame into a free buffer, or drop it if none is free
+    bool readBack(const sf::Texture& texture, int repeats, bool wait) {
+        int slot = -1;
+        {
+            std::unique_lock<std::mutex> lock(mutex);
+            if (wait) changed.wait(lock, [this] { return !freeSlots.empty(); });
+            if (!freeSlots.empty()) { slot = freeSlots.back(); freeSlots.pop_back(); }
+        }
+        if (slot < 0) { dropped++; return false; }
+		// Straight into the pooled buffer (copyToImage would allocate a whole frame each time).
+		// Rows come back bottom-up, as the window was copied; convert() flips them
+        Frame& frame = pool[slot];
+        sf::Texture::bind(&texture);
+        glPixelStorei(GL_PACK_ALIGNMENT, 1);
+        glGetTexImage(GL_TEXTURE_2D, 0, GL_RGBA, GL_UNSIGNED_BYTE, frame.rgba.data());
+        sf::Texture::bind(nullptr);
+        frame.sequence = nextSequence++;
+        frame.repeats = repeats;
+        captured++;
+        {
+            std::lock_guard<std::mutex> lock(mutex);
+            convertQueue.push_back(slot);
+        }
+        changed.notify_all();
+        return true;
+    }
+
+	// RGBA to I420 (full-range BT.601), chroma averaged over 2x2 blocks; source rows are bottom-up
+    void convert(Frame& frame) const {
+        const std::uint8_t* src = frame.rgba.data();
+        std::uint8_t* yPlane = frame.yuv.data();
+        std::uint8_t* uPlane = yPlane + static_cast<std::size_t>(size.x) * size.y;
+        std::uint8_t* vPlane = uPlane + static_cast<std::size_t>(size.x / 2) * (size.y / 2);
+        for (unsigned y = 0; y < size.y; y += 2) {
+            for (unsigned x = 0; x < size.x; x += 2) {
+                int sumR = 0, sumG = 0, sumB = 0;
+                for (unsigned dy = 0; dy < 2; dy++) {
+                    for (unsigned dx = 0; dx < 2; dx++) {
+                        const std::uint8_t* p = src + (static_cast<std::size_t>(size.y - 1 - (y + dy)) * size.x + (x + dx)) * 4;
+                        yPlane[static_cast<std::size_t>(y + dy) * size.x + (x + dx)] = static_cast<std::uint8_t>((77 * p[0] + 150 * p[1] + 29 * p[2]) >> 8);
+                        sumR += p[0]; sumG += p[1]; sumB += p[2];
+                    }
+                }
+                std::size_t c = static_cast<std::size_t>(y / 2) * (size.x / 2) + x / 2;
+                uPlane[c] = static_cast<std::uint8_t>(std::clamp(((-43 * sumR - 85 * sumG + 128 * sumB) >> 10) + 128, 0, 255));
+                vPlane[c] = static_cast<std::uint8_t>(std::clamp(((128 * sumR - 107 * sumG - 21 * sumB) >> 10) + 128, 0, 255));
+            }
+        }
+    }
+    void convertLoop() {
+        std::unique_lock<std::mutex> lock(mutex);
+        while (true) {
+            changed.wait(lock, [this] { return stopping || !convertQueue.empty(); });
+            if (convertQueue.empty()) return;
+            int slot = convertQueue.front();  // Oldest first, the writer waits on it
+            convertQueue.erase(convertQueue.begin());
+            lock.unlock();
+            convert(pool[slot]);
+            lock.lock();
+            pool[slot].converted = true;
+            changed.notify_all();
+        }
+    }
+	// Append converted frames in capture order, returning their buffers to the pool
+    void writeLoop() {
+        std::unique_lock<std::mutex> lock(mutex);
+        while (true) {
+            int slot = -1;
+            changed.wait(lock, [this, &slot] {
+                for (int i = 0; i < poolSize; i++) {
+                    if (pool[i].converted && pool[i].sequence == nextToWrite) { slot = i; return true; }
+                }
+                return stopping && freeSlots.size() == static_cast<std::size_t>(poolSize);
+            });
+            if (slot < 0) return;
+            lock.unlock();
+            for (int r = 0; r < pool[slot].repeats; r++) {
+                if (format == Y4M) file << "FRAME\n";
+                file.write(reinterpret_cast<const char*>(pool[slot].yuv.data()), static_cast<std::streamsize>(pool[slot].yuv.size()));
+            }
+            lock.lock();
+            pool[slot].converted = false;
+            freeSlots.push_back(slot);
+            nextToWrite++;
+            written += pool[slot].repeats;
+            changed.notify_all();
+        }
+    }
+};
+
+// ============================================================================
+// MAIN GAME CLASS
+// ============================================================================
+class Game {
+public:
+	// Window and timing
+    sf::RenderWindow window;
+    std::unique_ptr<OffscreenRecorder> offscreen;  // Headless mode: no window is opened
+    sf::Clock clock;
+    FramePacer framePacer;
+    bool showFrameStats = false;  // F3 toggles the pacing overlay
+    sf::Text* frameStatsText = nullptr;
+    sf::Clock frameStatsClock;
+    SpawnGovernor spawnGovernor;
+    sf::Clock renderClock;
+    sf::Time lastRenderTime;
+    VideoCapture videoCapture;  // F10 records, Shift+F10 records raw I420
+    ResolutionScaler resolutionScaler;
+    AllocationTracker allocationTracker;  // Per-frame heap allocations (F3), --alloc-check enforces zero
+    std::vector<GameState> sceneStack;            // Bottom to top; only the top scene updates and takes input
+    GameState currentState = GameState::MENU;     // Top of sceneStack
+
+    // Shared textures, sound buffers and fonts
+    ResourceCache resources;
+
+    // Audio
+    sf::Music gameMusic, menuMusic;
+    SoundBufferHandle shootBuffer, explosionBuffer;
+    sf::Sound shootSound, explosionSound, bossHitSound;
+
+    // Textures
+    TextureHandle bgTex, menuBgTex, highScoreBgTex, gameOverBgTex;
+    TextureHandle coinTex, healTex, boltTex, asteroidTex, bulletTex, playerBulletTex, bossTex;
+    std::vector<TextureHandle> playerTextures, enemyTextures;
+    std::vector<TextureHandle> explosionFrames;
+    AnimationLibrary animations;
+    sf::Sprite* highScoreSprite = nullptr;
+
+    // Game Objects
+    Player* player = nullptr;
+    Player* player2 = nullptr;  // Co-op partner, null in single player
+    PlayerInput playerInputs[2];
+    ScrollingBackground* background = nullptr;
+    StarField* stars = nullptr;
+    Boss* activeBoss = nullptr;
+    std::vector<Enemy> enemies;
+    EnemyKinematics enemyKinematics;
+    FlowField flowField;  // Steering shared by swarm drones
+    SwarmDrones drones;
+    BehaviourLibrary behaviours;  // Scripted enemy types
+    BehaviourVM behaviourVM;
+    std::vector<Bullet> enemyBullets, playerBullets;
+    std::vector<Missile> missiles;
+    SpatialIndex spatialIndex;  // Enemies, drones, asteroids and boss, rebuilt before each batch of queries
+    std::vector<Explosion> explosions;
+    std::vector<Asteroid> asteroids;
+    std::vector<Powerup> powerups;
+
+    // UI
+    Menu menu;
+    HUD hud;
+    GameOver gameOverScreen;
+    PauseMenu pauseMenu;
+    ScreenShake screenShake;
+    OptionsMenu optionsMenu; 
+
+    // State
+    Leaderboard leaderboard{ SaveFiles::path("leaderboard.bin") };  // Top runs, saved in the background
+    float runTime = 0.f;                          // Seconds played this run
+    Telemetry telemetry{ SaveFiles::path("telemetry.bin") };       // Gameplay event log
+    TimerWheel timers;                            // Cooldowns, spawns and timed powerups
+    ImpactEffects impacts;                        // Merges and budgets hit effects
+	bool bossSpawned = false;  // Track if a boss is currently spawned
+    int bossCount = 0;           // Track number of bosses defeated
+    int nextBossScore = 500;     // Score threshold for next boss
+    std::int32_t nextEnemyId = 1;  // Id for the next spawned enemy
+	float spawnTimerMax = 4.25f; // Enemy spawn interval
+	float asteroidSpawnTimerMax = 20.f; // Asteroid spawn interval
+    float swarmTimerMax = 30.f;  // Swarm wave interval
+    float spawnRetry = 0.1f;     // Delay before a blocked spawn tries again
+    int swarmWaveSize = 240;
+    int swarmColumns = 20;       // Formation grid, slots 30 x 28 apart
+    float swarmHoldTime = 10.f;  // Seconds in formation before the front row dives, then row by row
+    int dronePoints = 2;
+    SimRandom rng;                               // Gameplay randomness (part of snapshots)
+    std::unique_ptr<GameSnapshot> checkpoint;    // Captured when a boss spawns
+    std::int64_t gameOverFrame = -1;             // Co-op frame the run ended on, acted on once confirmed
+    bool gameOverPrefetched = false;             // Game over screen prefetched while hearts are low
+    std::optional<RunRecord> submittedRun;       // This run's leaderboard entry; a checkpoint retry replaces it
+    std::unique_ptr<GameSnapshot> quickSave;     // F5 / F9
+
+    // Co-op
+    std::unique_ptr<NetplaySession> netplay;
+    std::vector<GameSnapshot> rollbackSnapshots;  // State at the start of each recent frame
+    bool resimulating = false;                    // Replaying after a misprediction, stay silent
+	// Telemetry from co-op frames, held until the remote inputs of their frame are confirmed
+    struct FrameEvent { std::int64_t frame; Telemetry::Event event; };
+    std::vector<FrameEvent> unconfirmedEvents;
+    std::int64_t simulatingFrame = -1;            // Co-op frame being simulated, -1 outside one
+
+    // Loading screen
+    float loadingTimer = 0.f; 
+    float loadingDuration = 3.f;  // 3 seconds
+    TextureHandle loadingBgTex;
+    sf::Sprite* loadingSprite = nullptr;
+
+	// Constructor
+    explicit Game(std::unique_ptr<OffscreenRecorder> recorder = nullptr)
+        : offscreen(std::move(recorder)),
+          shootBuffer(resources.soundBuffer("assests/audio/shoot.mp3")),
+          explosionBuffer(resources.soundBuffer("assests/audio/explosion.mp3")),
+          shootSound(*shootBuffer), explosionSound(*explosionBuffer), bossHitSound(*explosionBuffer),
+          hud(resources.font("assests/font/Xirod.otf"))
+    {
+        std::srand(static_cast<unsigned>(std::time(nullptr)));
+        rng.seed(static_cast<std::uint32_t>(std::time(nullptr)));
+        registerSceneAssets();
+        behaviours.load("assests/behaviours");
+        AllocationTracker::current = AllocationTracker::OTHER;
+		// Entity storage sized to the snapshot limits up front, so play never has to grow it
+        enemies.reserve(GameSnapshot::maxEnemies);
+        playerBullets.reserve(GameSnapshot::maxPlayerBullets); enemyBullets.reserve(GameSnapshot::maxEnemyBullets);
+        missiles.reserve(GameSnapshot::maxMissiles); explosions.reserve(GameSnapshot::maxExplosions);
+        timers.reserve(GameSnapshot::maxTimers);
+        asteroids.reserve(GameSnapshot::maxAsteroids); powerups.reserve(GameSnapshot::maxPowerups);
+        enemyKinematics.reserve(GameSnapshot::maxEnemies);
+        spatialIndex.reserve(GameSnapshot::maxEnemies + GameSnapshot::maxDrones + GameSnapshot::maxAsteroids + 1);
+        behaviourVM.reserve(GameSnapshot::maxEnemies);
+        if (!offscreen) {
+            window.create(sf::VideoMode(Playfield::size()), "Space Shooter", sf::Style::Close | sf::Style::Titlebar | sf::Style::Resize);
+            framePacer.setMode(FramePacer::CAPPED, window);
+            resolutionScaler.resize(window.getSize());
+        }
+        pushScene(GameState::LOADING);
+        
+        // Load and display loading screen FIRST
+        loadingBgTex = resources.tryTexture("assests/textures/menu/loading.png");
+        if (!loadingBgTex) {
+            sf::Image img;
+            img.resize(Playfield::size(), sf::Color(20, 20, 40));
+            loadingBgTex = resources.textureFromImage(img);
+        }
+        loadingSprite = new sf::Sprite(*loadingBgTex);
+        loadingSprite->setScale({
+            Playfield::width / static_cast<float>(loadingBgTex->getSize().x),
+            Playfield::height / static_cast<float>(loadingBgTex->getSize().y)
+        });
+        
+        // Render loading screen immediately
+        renderTarget().setView(sceneView());
+        renderTarget().clear();
+        renderTarget().draw(*loadingSprite);
+        if (!offscreen) { resolutionScaler.present(window); window.display(); }
+        
+        // Now load all other assets (loading screen is visible during this)
+        loadAssets();
+        initObjects();
+        
+        // Transition to menu
+        replaceScenes(GameState::MENU);
+    }
+	// Destructor
+    ~Game() {
+        if (player) delete player;
+        if (player2) delete player2;
+        if (background) delete background;
+        if (stars) delete stars;
+        if (activeBoss) delete activeBoss;
+		if (highScoreSprite) delete highScoreSprite;
+		if (loadingSprite) delete loadingSprite;
+        if (frameStatsText) delete frameStatsText;
+    }
+	// Record the finished run and show the game over screen; later calls in the same frame do nothing
+    void endRun() {
+        if (currentState == GameState::GAME_OVER) return;
+		// A co-op death may be on a predicted frame; updateNetplay finishes the run once it is confirmed
+        if (netplay) return;
+        finishRun();
+    }
+    void finishRun() {
+        RunRecord run;
+        run.score = hud.getScore();
+        run.enemiesDefeated = hud.enemiesDefeated;
+        run.bosses = bossCount;
+        run.durationSeconds = runTime;
+        run.finishedAt = static_cast<std::int64_t>(std::time(nullptr));
+		// A retried run keeps one entry, its best attempt
+        if (!submittedRun || run.score > submittedRun->score) {
+            if (submittedRun) leaderboard.withdraw(*submittedRun);
+            leaderboard.submit(run);
+            submittedRun = run;
+        }
+        logEvent(Telemetry::RUN_ENDED, run.score);
+        replaceScenes(GameState::GAME_OVER);
+    }
+	// Push a gameplay event with the current entity counts (co-op frames wait for confirmation)
+    void logEvent(Telemetry::EventType type, int value, float x = 0.f, float y = 0.f) {
+        auto count = [](std::size_t n) { return static_cast<std::uint16_t>(std::min<std::size_t>(n, 0xFFFF)); };
+        Telemetry::Event event{ runTime, value, x, y, type, count(enemies.size()), count(asteroids.size()),
+            count(powerups.size()), count(enemyBullets.size()), count(playerBullets.size()) };
+        if (simulatingFrame >= 0) unconfirmedEvents.push_back({ simulatingFrame, event });
+        else telemetry.record(event);
+    }
+	// LOAD ALL ASSETS
+    void loadAssets() {
+        // Audio (sound buffers are decoded once by the cache in the constructor)
+        gameMusic.openFromFile("assests/audio/gamebm.mp3");
+        gameMusic.setLooping(true); gameMusic.setVolume(40.f);
+        menuMusic.openFromFile("assests/audio/menubm.mp3");
+        menuMusic.setLooping(true); menuMusic.setVolume(50.f);
+        shootSound.setVolume(10.f);
+        explosionSound.setVolume(80.f);
+        bossHitSound.setPitch(2.0f); bossHitSound.setVolume(60.f);
+
+        // Textures
+        bgTex = resources.tryTexture("assests/textures/background/background22.png");
+        if (!bgTex) {
+            sf::Image img; img.resize({ 800, 600 }, sf::Color::Black); bgTex = resources.textureFromImage(img);
+        }
+        menuBgTex = resources.texture("assests/textures/menu/menubg.png", bgTex);
+		// Power-up, asteroid and boss textures
+        coinTex = resources.scaledTexture("assests/textures/powerups/p3.png", ArtScale::powerup);
+        healTex = resources.scaledTexture("assests/textures/powerups/p2.png", ArtScale::powerup);
+        boltTex = resources.scaledTexture("assests/textures/powerups/p1.png", ArtScale::powerup);
+        asteroidTex = resources.scaledTexture("assests/textures/enemy/asteroid.png", ArtScale::asteroid);
+        bulletTex = resources.texture("assests/textures/enemy/bullet2.png");
+        playerBulletTex = resources.texture("assests/textures/player/bullet2.png");
+        bossTex = resources.scaledTexture("assests/textures/enemy/boss.png", ArtScale::boss);
+
+        // Explosion frames
+        for (int i = 1; i <= 5; i++) {
+            if (TextureHandle tex = resources.tryTexture("assests/textures/enemy animation/explosion" + std::to_string(i) + ".png"))
+                explosionFrames.push_back(tex);
+        }
+        animations.define(AnimationLibrary::EXPLOSION, explosionFrames, 0.05f);
+        animations.define(AnimationLibrary::PLAYER_EXPLOSION, explosionFrames, 0.05f);
+
+        // Player textures
+        for (int i = 1; i <= 5; i++)
+            playerTextures.push_back(resources.texture("assests/textures/player/spaceship" + std::to_string(i) + ".png"));
+        animations.define(AnimationLibrary::PLAYER_BANK, playerTextures, 0.05f);
+
+        // Enemy textures
+        for (int i = 1; i <= 6; i++) {
+            TextureHandle tex = resources.scaledTexture("assests/textures/enemy/enemy" + std::to_string(i) + ".png", ArtScale::enemy, playerTextures[2]);
+            if (tex == playerTextures[2]) tex = resources.scaledTexture("assests/textures/player/spaceship3.png", ArtScale::enemy);
+            enemyTextures.push_back(tex);
+        }
+
+#ifndef NDEBUG
+        resources.printReport(std::cout);
+#endif
+    }
+
+	// Initialize game objects
+    void initObjects() {
+        menu.loadAssets(menuBgTex.get());
+        hud.loadAssets(resources);
+        gameOverScreen.init(0.10f);
+        pauseMenu.loadAssets(hud.getFontHandle());
+        optionsMenu.loadAssets(hud.getFontHandle());
+
+        frameStatsText = new sf::Text(hud.getFont(), "", 14);
+        frameStatsText->setFillColor(sf::Color(180, 255, 180));
+        frameStatsText->setPosition({ 10.f, 875.f });
+
+        player = new Player(playerTextures);
+        player->setPosition(600.f, 750.f);
+        startRunTimers();
+        background = new ScrollingBackground(*bgTex, 50.f);
+        stars = new StarField(25, Playfield::size());
+    }
+
+	// Menu-only files, grouped by the state that shows them
+    void registerSceneAssets() {
+        resources.sceneAssets[GameState::LOADING] = { "assests/textures/menu/loading.png" };
+        resources.sceneAssets[GameState::OPTIONS] = {
+            "assests/textures/menu/options.png", "assests/textures/menu/controls.png", "assests/textures/menu/credits.png" };
+        resources.sceneAssets[GameState::HIGHSCORE] = { "assests/textures/menu/highscore.png" };
+        resources.sceneAssets[GameState::GAME_OVER] = {
+            "assests/textures/menu/menubg4.png", "assests/textures/player/explosion.jpg" };
+    }
+	// Load the menu-only assets of a state
+    void acquireSceneAssets(GameState state) {
+        if (state == GameState::OPTIONS) {
+            optionsMenu.acquireAssets(resources);
+        }
+        else if (state == GameState::HIGHSCORE) {
+            highScoreBgTex = resources.texture("assests/textures/menu/highscore.png", menuBgTex);
+            highScoreSprite = new sf::Sprite(*highScoreBgTex);
+            highScoreSprite->setScale({ 
+                Playfield::width / static_cast<float>(highScoreBgTex->getSize().x), 
+                Playfield::height / static_cast<float>(highScoreBgTex->getSize().y) 
+            });
+        }
+        else if (state == GameState::GAME_OVER) {
+            gameOverBgTex = resources.texture("assests/textures/menu/menubg4.png", menuBgTex);
+            std::vector<TextureHandle> frames = resources.sheetFrames("assests/textures/player/explosion.jpg", 3, 2, sf::Color::White);
+            animations.define(AnimationLibrary::GAME_OVER, frames.empty() ? explosionFrames : frames, gameOverScreen.duration);
+            gameOverScreen.setAssets(animations[AnimationLibrary::GAME_OVER], *gameOverBgTex);
+        }
+    }
+	// Drop the menu-only assets of a state so the cache may evict them
+    void releaseSceneAssets(GameState state) {
+        if (state == GameState::LOADING) {
+            if (loadingSprite) { delete loadingSprite; loadingSprite = nullptr; }
+            loadingBgTex = nullptr;
+        }
+        else if (state == GameState::OPTIONS) {
+            optionsMenu.releaseAssets();
+        }
+        else if (state == GameState::HIGHSCORE) {
+            if (highScoreSprite) { delete highScoreSprite; highScoreSprite = nullptr; }
+            highScoreBgTex = nullptr;
+        }
+        else if (state == GameState::GAME_OVER) {
+            gameOverScreen.releaseAssets();
+            animations.release(AnimationLibrary::GAME_OVER);
+            gameOverBgTex = nullptr;
+        }
+    }
+
+	// Cover the current scene with another; the one below is suspended, not torn down
+    void pushScene(GameState scene) {
+        if (!sceneStack.empty()) suspendScene(sceneStack.back());
+        sceneStack.push_back(scene);
+        currentState = scene;
+        enterScene(scene);
+    }
+	// Leave the top scene and resume the one below it
+    void popScene() {
+        if (sceneStack.size() < 2) return;
+        exitScene(sceneStack.back());
+        sceneStack.pop_back();
+        currentState = sceneStack.back();
+        resumeScene(currentState);
+    }
+	// Leave every scene, top first, and start over with one
+    void replaceScenes(GameState scene) {
+        while (!sceneStack.empty()) {
+            GameState top = sceneStack.back();
+            sceneStack.pop_back();
+            exitScene(top);
+        }
+        sceneStack.push_back(scene);
+        currentState = scene;
+        enterScene(scene);
+    }
+	// A run is in progress, possibly under the pause menu
+    bool inRun() const { return currentState == GameState::PLAYING || currentState == GameState::PAUSED; }
+	// Scene hooks: each runs once per transition. A scene's menu-only assets live from enter to exit.
+    void enterScene(GameState scene) {
+        acquireSceneAssets(scene);
+        resources.trim(scene);
+        switch (scene) {
+        case GameState::MENU: menu.reset(); prefetchForSelection(menu.selectedIconIndex); break;
+        case GameState::GAME_OVER: gameOverScreen.reset(); break;
+        case GameState::OPTIONS: optionsMenu.reset(); break;
+        case GameState::PAUSED: pauseMenu.setPaused(true); break;
+        default: break;
+        }
+        playSceneMusic(scene);
+    }
+    void exitScene(GameState scene) {
+        if (scene == GameState::PAUSED) { pauseMenu.setPaused(false); pauseMenu.resetAction(); }
+		// Cached menu layers are full-screen textures; none of them is needed outside its scene
+        if (scene == GameState::MENU) menu.layer.release();
+        else if (scene == GameState::GAME_OVER) gameOverScreen.menu.layer.release();
+        else if (scene == GameState::PAUSED) pauseMenu.layer.release();
+        releaseSceneAssets(scene);
+    }
+    void suspendScene(GameState scene) {
+		// Button presses that led away are consumed
+        if (scene == GameState::MENU) menu.reset();
+        else if (scene == GameState::GAME_OVER) gameOverScreen.menu.reset();
+    }
+    void resumeScene(GameState scene) {
+        resources.trim(scene);
+        if (scene == GameState::MENU) prefetchForSelection(menu.selectedIconIndex);
+        else if (scene == GameState::GAME_OVER && gameOverScreen.showMenu) prefetchForSelection(gameOverScreen.menu.selectedIconIndex);
+        playSceneMusic(scene);
+    }
+	// Menus play the menu track and a run the game track; options and high scores keep what was playing
+    void playSceneMusic(GameState scene) {
+        sf::Music* track = nullptr;
+        sf::Music* other = nullptr;
+        if (scene == GameState::MENU || scene == GameState::GAME_OVER) { track = &menuMusic; other = &gameMusic; }
+        else if (scene == GameState::PLAYING || scene == GameState::PAUSED) { track = &gameMusic; other = &menuMusic; }
+        if (!track || offscreen) return;
+        if (other->getStatus() != sf::Music::Status::Stopped) other->stop();
+        if (track->getStatus() != sf::Music::Status::Playing) track->play();
+    }
+	// Start decoding assets for the screen a highlighted menu button leads to
+    void prefetchForSelection(int selectedIndex) {
+        if (selectedIndex == 1) resources.prefetchScene(GameState::OPTIONS);
+        else if (selectedIndex == 2) resources.prefetchScene(GameState::HIGHSCORE);
+    }
+
+	// Reset game state
+    void resetGame() {
+        enemies.clear(); drones.clear();
+        if (activeBoss) { delete activeBoss; activeBoss = nullptr; }
+        bossSpawned = false;
+        bossCount = 0;              // Reset boss counter
+        nextBossScore = 500;        // Reset next boss threshold
+        nextEnemyId = 1;
+        enemyBullets.clear(); playerBullets.clear(); missiles.clear();
+        explosions.clear(); asteroids.clear(); powerups.clear();
+        hud.reset(); hud.loadAssets(resources);
+        player->setPosition(600.f, 750.f); player->resetBank(); player->resetEffects();
+        if (player2) { player->setPosition(450.f, 750.f); player2->setPosition(750.f, 750.f); player2->resetBank(); player2->resetEffects(); }
+        spawnGovernor.pressure = 0.f;
+        runTime = 0.f;
+        impacts.reset();
+        timers.clear();
+        startRunTimers();
+        checkpoint.reset();
+        gameOverFrame = -1;
+        submittedRun.reset();
+    }
+
+	// Capture the complete simulation state
+    bool captureSnapshot(GameSnapshot& out) const {
+        out.header = GameSnapshot::magic;
+        out.headerVersion = GameSnapshot::version;
+        out.behaviourSignature = behaviours.signature;
+        out.rngState = rng.state;
+        out.score = hud.score; out.hearts = hud.currentHearts; out.enemiesDefeated = hud.enemiesDefeated;
+        out.bossCount = bossCount; out.nextBossScore = nextBossScore; out.bossSpawned = bossSpawned; out.nextEnemyId = nextEnemyId;
+        out.runTime = runTime;
+        out.shakeAmount = screenShake.shakeAmount; out.shakeDuration = screenShake.shakeDuration;
+        out.shakeTimer = screenShake.shakeTimer; out.maxShakeDuration = screenShake.maxShakeDuration;
+        out.backgroundY1 = background->bg1.getPosition().y; out.backgroundY2 = background->bg2.getPosition().y;
+        out.powerupMessageTimer = hud.powerupMessageTimer; out.showPowerupMessage = hud.showPowerupMessage;
+        std::string message = hud.powerupText.getString().toAnsiString();
+        std::memset(out.powerupMessage, 0, sizeof(out.powerupMessage));
+        std::memcpy(out.powerupMessage, message.c_str(), std::min(message.size(), sizeof(out.powerupMessage) - 1));
+		// Players
+        auto capturePlayer = [](const Player& p) {
+            return GameSnapshot::PlayerState{ p.getPosition().x, p.getPosition().y, p.getRotation().asDegrees(),
+                p.bankStart, p.bankFrom, p.bankTarget, p.attackReady, p.tripleShot, p.homing };
+        };
+        out.player = capturePlayer(*player);
+        out.hasPlayer2 = player2 != nullptr;
+        if (player2) out.player2 = capturePlayer(*player2);
+		// Boss
+        out.hasBoss = activeBoss != nullptr;
+        if (activeBoss) {
+            out.boss = { activeBoss->getPosition().x, activeBoss->getPosition().y, activeBoss->bulletSpeed,
+                activeBoss->hp, activeBoss->maxHp, activeBoss->movingRight, activeBoss->volleyIndex };
+        }
+		// Enemies
+        out.enemyCount = static_cast<std::int32_t>(std::min<std::size_t>(enemies.size(), GameSnapshot::maxEnemies));
+        for (int i = 0; i < out.enemyCount; i++) {
+            const Enemy& e = enemies[i];
+            std::int32_t textureIndex = 0;
+            for (std::size_t t = 0; t < enemyTextures.size(); t++) if (&e.sprite.getTexture() == enemyTextures[t].get()) textureIndex = static_cast<std::int32_t>(t);
+            out.enemies[i] = { e.getPosition().x, e.getPosition().y, e.startX, e.sineTimer, e.shootCooldown, e.opTimer,
+                e.id, e.hp, textureIndex, e.behaviour, static_cast<std::int32_t>(e.pc), e.autofireOp, e.volleyIndex, e.shot };
+        }
+		// Swarm drones (capped by SwarmDrones itself)
+        out.droneCount = static_cast<std::int32_t>(drones.count());
+        for (int i = 0; i < out.droneCount; i++) {
+            out.drones[i] = { drones.x[i], drones.y[i], drones.velocityX[i], drones.velocityY[i],
+                drones.slotX[i], drones.slotY[i], drones.age[i], drones.diveAt[i], drones.health[i] };
+        }
+		// Bullets
+        auto captureBullets = [](const std::vector<Bullet>& from, GameSnapshot::BulletState* to, int capacity) {
+            std::int32_t count = static_cast<std::int32_t>(std::min<std::size_t>(from.size(), capacity));
+            for (int i = 0; i < count; i++) {
+                const Bullet& b = from[i];
+                to[i] = { b.getPosition().x, b.getPosition().y, b.direction.x, b.direction.y, b.sprite.getRotation().asDegrees(), b.speed, b.timeToLive };
+            }
+            return count;
+        };
+        out.playerBulletCount = captureBullets(playerBullets, out.playerBullets, GameSnapshot::maxPlayerBullets);
+        out.enemyBulletCount = captureBullets(enemyBullets, out.enemyBullets, GameSnapshot::maxEnemyBullets);
+        out.missileCount = static_cast<std::int32_t>(std::min<std::size_t>(missiles.size(), GameSnapshot::maxMissiles));
+        for (int i = 0; i < out.missileCount; i++) {
+            const Missile& m = missiles[i];
+            out.missiles[i] = { m.getPosition().x, m.getPosition().y, m.direction.x, m.direction.y, m.timeToLive };
+        }
+		// Timers
+        out.timerTick = timers.tick; out.timerRemainder = timers.remainder;
+        out.timerCount = static_cast<std::int32_t>(std::min<std::size_t>(timers.pool.size(), GameSnapshot::maxTimers));
+        for (int i = 0; i < out.timerCount; i++) {
+            const TimerWheel::Timer& t = timers.pool[i];
+            out.timers[i] = { t.due, t.generation, t.slot >= 0, t.event, t.a, t.b };
+        }
+		// Effects, asteroids and powerups
+        out.explosionCount = static_cast<std::int32_t>(std::min<std::size_t>(explosions.size(), GameSnapshot::maxExplosions));
+        for (int i = 0; i < out.explosionCount; i++) {
+            const Explosion& e = explosions[i];
+            out.explosions[i] = { e.sprite.getPosition().x, e.sprite.getPosition().y, e.startTime, e.strength, e.clip, e.priority };
+        }
+        out.asteroidCount = static_cast<std::int32_t>(std::min<std::size_t>(asteroids.size(), GameSnapshot::maxAsteroids));
+        for (int i = 0; i < out.asteroidCount; i++) {
+            const Asteroid& a = asteroids[i];
+            out.asteroids[i] = { a.getPosition().x, a.getPosition().y, a.sprite.getRotation().asDegrees(), a.health };
+        }
+        out.powerupCount = static_cast<std::int32_t>(std::min<std::size_t>(powerups.size(), GameSnapshot::maxPowerups));
+        for (int i = 0; i < out.powerupCount; i++) {
+            const Powerup& p = powerups[i];
+            out.powerups[i] = { p.sprite.getPosition().x, p.sprite.getPosition().y, static_cast<std::int32_t>(p.type) };
+        }
+		// Anything past the caps was left out; enforceSnapshotCaps keeps play within them
+        bool complete = enemies.size() <= GameSnapshot::maxEnemies && playerBullets.size() <= GameSnapshot::maxPlayerBullets
+            && enemyBullets.size() <= GameSnapshot::maxEnemyBullets && missiles.size() <= GameSnapshot::maxMissiles
+            && explosions.size() <= GameSnapshot::maxExplosions && asteroids.size() <= GameSnapshot::maxAsteroids
+            && powerups.size() <= GameSnapshot::maxPowerups && timers.pool.size() <= GameSnapshot::maxTimers;
+        if (!complete) std::cerr << "Snapshot incomplete: entity counts exceed GameSnapshot caps\n";
+        return complete;
+    }
+	// Drop the oldest bullets, missiles and powerups past what a snapshot stores, so saves and
+	// rollback always see the whole simulation (enemies, asteroids and explosions are held
+	// under their caps by the spawn governor)
+    void enforceSnapshotCaps() {
+        auto cap = [](auto& items, int limit) {
+            if (items.size() > static_cast<std::size_t>(limit)) items.erase(items.begin(), items.end() - limit);
+        };
+        cap(playerBullets, GameSnapshot::maxPlayerBullets);
+        cap(enemyBullets, GameSnapshot::maxEnemyBullets);
+        cap(missiles, GameSnapshot::maxMissiles);
+        cap(powerups, GameSnapshot::maxPowerups);
+    }
+
+	// Rebuild the simulation from a snapshot
+    void restoreSnapshot(const GameSnapshot& in) {
+        rng.state = in.rngState;
+        hud.score = in.score; hud.currentHearts = in.hearts; hud.enemiesDefeated = in.enemiesDefeated;
+        hud.addScore(0);
+        bossCount = in.bossCount; nextBossScore = in.nextBossScore; bossSpawned = in.bossSpawned != 0; nextEnemyId = in.nextEnemyId;
+        runTime = in.runTime;
+        screenShake.shakeAmount = in.shakeAmount; screenShake.shakeDuration = in.shakeDuration;
+        screenShake.shakeTimer = in.shakeTimer; screenShake.maxShakeDuration = in.maxShakeDuration;
+        background->bg1.setPosition({ 0.f, in.backgroundY1 }); background->bg2.setPosition({ 0.f, in.backgroundY2 });
+        hud.showPowerupMessage = false;
+        if (in.showPowerupMessage) {
+            hud.showPowerup(std::string(in.powerupMessage, strnlen(in.powerupMessage, sizeof(in.powerupMessage))).c_str());
+            hud.powerupMessageTimer = in.powerupMessageTimer;
+        }
+		// Players
+        auto restorePlayer = [this](Player& p, const GameSnapshot::PlayerState& state) {
+            p.setPosition(state.x, state.y);
+            p.sprite.setRotation(sf::degrees(state.rotationDeg));
+            p.attackReady = state.attackReady != 0; p.tripleShot = state.tripleShot; p.homing = state.homing;
+            p.bankStart = state.bankStart;
+            p.bankFrom = std::max(0, std::min(state.bankFrom, 4));
+            p.bankTarget = std::max(0, std::min(state.bankTarget, 4));
+        };
+        restorePlayer(*player, in.player);
+        if (player2 && in.hasPlayer2) restorePlayer(*player2, in.player2);
+		// Boss
+        if (activeBoss) { delete activeBoss; activeBoss = nullptr; }
+        if (in.hasBoss) {
+            activeBoss = new Boss(*bossTex, in.boss.maxHp, in.boss.bulletSpeed);
+            activeBoss->hp = in.boss.hp;
+            activeBoss->sprite.setPosition({ in.boss.x, in.boss.y });
+            activeBoss->movingRight = in.boss.movingRight != 0;
+            activeBoss->volleyIndex = in.boss.volleyIndex;
+        }
+		// Enemies
+        enemies.clear();
+        enemies.reserve(in.enemyCount);
+        for (int i = 0; i < in.enemyCount; i++) {
+            const GameSnapshot::EnemyState& e = in.enemies[i];
+            int textureIndex = std::max(0, std::min(e.textureIndex, static_cast<int>(enemyTextures.size()) - 1));
+            enemies.emplace_back(*enemyTextures[textureIndex], e.startX, e.y, e.shootCooldown);
+            Enemy& enemy = enemies.back();
+            enemy.sprite.setPosition({ e.x, e.y });
+            enemy.sineTimer = e.sineTimer; enemy.hp = e.hp;
+            enemy.id = e.id; enemy.shot = e.shot;  // The timer pool is restored slot by slot below, so the handle stays valid
+            if (e.behaviour >= 0 && e.behaviour < static_cast<int>(behaviours.programs.size())) {
+				// Program counter may sit one past the end (finished); autofire must name an autofire instruction
+                const std::vector<BehaviourOp>& ops = behaviours.programs[e.behaviour].ops;
+                int opCount = static_cast<int>(ops.size());
+                enemy.behaviour = e.behaviour; enemy.opTimer = e.opTimer; enemy.volleyIndex = e.volleyIndex;
+                enemy.pc = static_cast<std::uint32_t>(std::max(0, std::min(e.pc, opCount)));
+                bool autofire = e.autofireOp >= 0 && e.autofireOp < opCount && ops[e.autofireOp].code == BehaviourOp::AUTOFIRE;
+                enemy.autofireOp = autofire ? e.autofireOp : -1;
+            }
+        }
+		// Swarm drones
+        drones.clear();
+        for (int i = 0; i < in.droneCount; i++) {
+            const GameSnapshot::DroneState& d = in.drones[i];
+            drones.add({ d.x, d.y }, { d.slotX, d.slotY }, d.diveAt);
+            drones.velocityX.back() = d.velocityX; drones.velocityY.back() = d.velocityY;
+            drones.age.back() = d.age; drones.health.back() = d.health;
+        }
+		// Bullets
+        auto restoreBullets = [](std::vector<Bullet>& to, const GameSnapshot::BulletState* from, int count, const sf::Texture& tex) {
+            to.clear();
+            to.reserve(count);
+            for (int i = 0; i < count; i++) {
+                to.emplace_back(tex, from[i].x, from[i].y, from[i].dirX, from[i].dirY, from[i].rotationDeg);
+                to.back().speed = from[i].speed;
+                to.back().timeToLive = from[i].timeToLive;
+            }
+        };
+        restoreBullets(playerBullets, in.playerBullets, in.playerBulletCount, *playerBulletTex);
+        restoreBullets(enemyBullets, in.enemyBullets, in.enemyBulletCount, *bulletTex);
+        missiles.clear();
+        for (int i = 0; i < in.missileCount; i++) {
+            const GameSnapshot::MissileState& m = in.missiles[i];
+            missiles.emplace_back(*playerBulletTex, m.x, m.y, m.dirX, m.dirY);
+            missiles.back().timeToLive = m.timeToLive;
+        }
+		// Timers: pool slots keep their index and generation, so restored handles still match
+        timers.tick = in.timerTick; timers.remainder = in.timerRemainder;
+        timers.pool.resize(std::max<std::size_t>(timers.pool.size(), in.timerCount));
+        for (std::size_t i = 0; i < timers.pool.size(); i++) {
+            TimerWheel::Timer& t = timers.pool[i];
+            if (static_cast<int>(i) >= in.timerCount) { if (t.slot >= 0) t.generation++; t.slot = -1; continue; }
+            const GameSnapshot::TimerState& saved = in.timers[i];
+            t.due = saved.due; t.generation = saved.generation;
+            t.event = static_cast<TimerWheel::Event>(saved.event); t.a = saved.a; t.b = saved.b;
+            t.slot = saved.pending ? 0 : -1;
+        }
+        timers.relink();
+		// Effects, asteroids and powerups
+        explosions.clear();
+        for (int i = 0; i < in.explosionCount; i++) {
+            const GameSnapshot::ExplosionState& e = in.explosions[i];
+            int clip = e.clip == AnimationLibrary::PLAYER_EXPLOSION ? AnimationLibrary::PLAYER_EXPLOSION : AnimationLibrary::EXPLOSION;
+            if (animations[clip].empty()) continue;
+            explosions.emplace_back(animations, clip, e.x, e.y, e.startTime);
+            explosions.back().setStrength(std::max(1.f, std::min(e.strength, impacts.maxStrength)));
+            explosions.back().priority = e.priority;
+        }
+        asteroids.clear();
+        for (int i = 0; i < in.asteroidCount; i++) {
+            const GameSnapshot::AsteroidState& a = in.asteroids[i];
+            asteroids.emplace_back(*asteroidTex, a.x, a.y);
+            asteroids.back().sprite.setRotation(sf::degrees(a.rotationDeg));
+            asteroids.back().health = a.health;
+            asteroids.back().isAlive = a.health > 0;
+        }
+        powerups.clear();
+        for (int i = 0; i < in.powerupCount; i++) {
+            const GameSnapshot::PowerupState& p = in.powerups[i];
+            auto type = static_cast<Powerup::Type>(p.type);
+            powerups.emplace_back(powerupTexture(type), type, p.x, p.y);
+        }
+    }
+
+	// Write a snapshot to disk as one binary block
+    bool saveSnapshot(const GameSnapshot& snapshot, const std::string& path) const {
+        std::ofstream file(path, std::ios::binary);
+        if (!file.is_open()) return false;
+        file.write(reinterpret_cast<const char*>(&snapshot), sizeof(GameSnapshot));
+        return static_cast<bool>(file);
+    }
+	// Read a snapshot from disk
+    bool loadSnapshot(GameSnapshot& snapshot, const std::string& path) const {
+        std::ifstream file(path, std::ios::binary);
+        if (!file.is_open()) return false;
+        file.read(reinterpret_cast<char*>(&snapshot), sizeof(GameSnapshot));
+        return static_cast<bool>(file) && snapshot.isValid() && snapshot.behaviourSignature == behaviours.signature;
+    }
+	// Continue playing from a snapshot (quick load or checkpoint retry)
+    void resumeFromSnapshot(const GameSnapshot& snapshot) {
+        restoreSnapshot(snapshot);
+        if (currentState != GameState::PLAYING) replaceScenes(GameState::PLAYING);
+    }
+
+	// Start a co-op game against a peer; play begins once the peer answers
+    bool startNetplay(unsigned short localPort, const std::string& host, unsigned short remotePort, int localPlayer) {
+        auto session = std::make_unique<NetplaySession>();
+        if (!session->start(localPort, host, remotePort, localPlayer)) return false;
+        netplay = std::move(session);
+        rollbackSnapshots.resize(NetplaySession::historySize);
+        unconfirmedEvents.reserve(256);
+        if (!player2) player2 = new Player(playerTextures);
+        player2->sprite.setColor(sf::Color(150, 200, 255));
+        resetGame();
+        replaceScenes(GameState::PLAYING);
+        return true;
+    }
+	// Leave co-op; the next game is single player again
+    void endNetplay() {
+        netplay->send();
+        netplay.reset();
+        rollbackSnapshots.clear();
+        rollbackSnapshots.shrink_to_fit();
+        unconfirmedEvents.clear();
+        delete player2; player2 = nullptr;
+    }
+	// Advance the co-op simulation in fixed ticks, rolling back when a remote input was mispredicted
+    void updateNetplay(sf::Time dt) {
+        NetplaySession& net = *netplay;
+        net.receive();
+        if (!net.ready()) {
+            net.send();
+            hud.showPowerup(("WAITING FOR PLAYER " + std::to_string(2 - net.localPlayer)).c_str());
+            return;
+        }
+        if (!net.started) {
+            // Both peers begin from the same seed and a fresh game
+            net.started = true;
+            rng.seed(net.seed);
+            resetGame();
+        }
+		// The peer went quiet: end the co-op run here rather than wait for inputs that will not come
+        if (net.peerLost()) {
+            std::string message = "PLAYER " + std::to_string(2 - net.localPlayer) + " DISCONNECTED";
+            finishRun();
+            endNetplay();
+            hud.showPowerup(message.c_str());
+            return;
+        }
+		// Re-simulate from the first wrong frame with the corrected inputs (a death predicted
+		// after it is re-decided by the corrected frames)
+        if (net.rollbackFrame >= 0) {
+            restoreSnapshot(rollbackSnapshots[net.slot(net.rollbackFrame)]);
+            gameOverFrame = -1;
+            std::int64_t from = net.rollbackFrame;
+            unconfirmedEvents.erase(std::remove_if(unconfirmedEvents.begin(), unconfirmedEvents.end(),
+                [from](const FrameEvent& e) { return e.frame >= from; }), unconfirmedEvents.end());
+            resimulating = true;
+            for (std::int64_t f = net.rollbackFrame; f < net.frame && gameOverFrame < 0; f++) simulateNetplayFrame(f);
+            resimulating = false;
+            net.rollbackFrame = -1;
+        }
+		// New frames: the local input applies at once, no added delay. A paused player sends a
+		// neutral input, since the pause menu is steered with the same arrow keys as the ship
+        net.accumulator = std::min(net.accumulator + dt.asSeconds(), NetplaySession::tickSeconds * NetplaySession::maxRollback);
+        PlayerInput local = currentState == GameState::PAUSED ? PlayerInput() : PlayerInput::fromKeyboard();
+        while (net.accumulator >= NetplaySession::tickSeconds && net.canAdvance() && inRun() && gameOverFrame < 0) {
+            net.accumulator -= NetplaySession::tickSeconds;
+            net.localInputs[net.slot(net.frame)] = local.bits;
+            simulateNetplayFrame(net.frame);
+            net.frame++;
+        }
+        net.send();
+		// Log what happened on frames that can no longer be rolled back, in frame order
+        std::size_t confirmed = 0;
+        while (confirmed < unconfirmedEvents.size() && unconfirmedEvents[confirmed].frame <= net.confirmedFrame)
+            telemetry.record(unconfirmedEvents[confirmed++].event);
+        unconfirmedEvents.erase(unconfirmedEvents.begin(), unconfirmedEvents.begin() + confirmed);
+		// Game over only once both peers' inputs up to the fatal frame are known
+        if (gameOverFrame >= 0 && net.confirmedFrame >= gameOverFrame) finishRun();
+        if (!inRun()) endNetplay();
+    }
+	// One deterministic tick, keeping the state it started from for rollback
+    void simulateNetplayFrame(std::int64_t frame) {
+        NetplaySession& net = *netplay;
+        captureSnapshot(rollbackSnapshots[net.slot(frame)]);
+        playerInputs[net.localPlayer].bits = net.localInputs[net.slot(frame)];
+        playerInputs[1 - net.localPlayer].bits = net.remoteInput(frame);
+        simulatingFrame = frame;
+        updatePlaying(sf::seconds(NetplaySession::tickSeconds));
+        simulatingFrame = -1;
+        if (!hud.isAlive()) gameOverFrame = frame;
+    }
+
+	// How long the loop may block waiting for input; zero while anything animates
+    sf::Time idleTimeout() const {
+        switch (currentState) {
+        case GameState::MENU: case GameState::OPTIONS: case GameState::HIGHSCORE:
+            return sf::seconds(0.5f);
+        case GameState::GAME_OVER:
+            return gameOverScreen.showMenu ? sf::seconds(0.5f) : sf::Time::Zero;
+        case GameState::PAUSED:
+            // Wake for the pause icon pulse; a co-op game keeps running under the menu
+            return !netplay ? sf::seconds(1.f / 20.f) : sf::Time::Zero;
+        default:
+            return sf::Time::Zero;
+        }
+    }
+
+	// Scene texture (upscaled into the window), or the offscreen texture in headless mode
+    sf::RenderTarget& renderTarget() {
+        if (offscreen) return offscreen->target;
+        return *resolutionScaler.scene;
+    }
+	// Logical 1200x900 view for the current render target
+    sf::View sceneView() const {
+        if (offscreen) return sf::View(sf::FloatRect({ 0.f, 0.f }, { Playfield::width, Playfield::height }));
+        return resolutionScaler.view();
+    }
+
+	// Main game loop
+    void run() {
+        if (offscreen) { runOffscreen(); return; }
+        while (window.isOpen()) {
+			// Idle screens sleep in the OS until input or the next timer instead of spinning
+            sf::Time idleWait = idleTimeout();
+            GameState stateBefore = currentState;
+            sf::Time dt;
+            {
+                AllocationTracker::Scope tag(AllocationTracker::EVENTS);
+                if (idleWait != sf::Time::Zero) {
+                    if (const std::optional event = window.waitEvent(idleWait)) handleEvent(*event);
+                }
+                dt = clock.restart();
+                processEvents();
+            }
+            // A scene entered this frame starts with one nominal step, not the idle wait that preceded it
+            if (currentState != stateBefore) dt = std::min(dt, sf::seconds(static_cast<float>(1.0 / framePacer.targetFps)));
+            sf::Clock simClock;
+            bool steady = isSteadyFrame();
+            {
+                AllocationTracker::Scope tag(AllocationTracker::SIMULATION);
+                update(dt);
+            }
+            sf::Time simTime = simClock.getElapsedTime();
+            render();
+            endAllocationFrame(steady && isSteadyFrame());
+            if (allocationTracker.failed) window.close();
+            // Co-op keeps the governor idle: its limits depend on local frame times and would desync peers
+            if (currentState == GameState::PLAYING && !netplay)
+                spawnGovernor.update(simTime, lastRenderTime, framePacer.targetFps, dt);
+            // Full frame time (dt), unless it includes this frame's idle wait
+            if (idleWait == sf::Time::Zero) resolutionScaler.update(dt, framePacer.targetFps, dt);
+            if (idleWait != sf::Time::Zero) framePacer.skipFrame();
+            else framePacer.endFrame();
+        }
+    }
+
+	// Start or stop recording the window
+    void toggleVideoCapture(bool raw) {
+        if (videoCapture.isRecording()) {
+            videoCapture.stop();
+            std::cout << videoCapture.summary() << std::endl;
+            hud.showPowerup("RECORDING SAVED");
+            return;
+        }
+        std::string path = "capture_" + std::to_string(std::time(nullptr)) + (raw ? ".yuv" : ".y4m");
+        auto format = raw ? VideoCapture::RAW_I420 : VideoCapture::Y4M;
+        if (videoCapture.start(path, window.getSize(), static_cast<int>(framePacer.targetFps), format)) hud.showPowerup("RECORDING");
+    }
+
+	// Headless run: fixed 60 Hz steps, the main menu first, then scripted play with no input
+    void runOffscreen() {
+        const sf::Time dt = sf::seconds(1.f / 60.f);
+        while (!offscreen->finished() && !allocationTracker.failed) {
+            if (currentState == GameState::MENU && offscreen->frameIndex >= offscreen->menuFrames) replaceScenes(GameState::PLAYING);
+            bool steady = isSteadyFrame();
+            {
+                AllocationTracker::Scope tag(AllocationTracker::SIMULATION);
+                update(dt);
+            }
+            render();
+            endAllocationFrame(steady && isSteadyFrame());
+        }
+        if (!offscreen->failedPath.empty()) std::cerr << "Offscreen: cannot write " << offscreen->failedPath << std::endl;
+        std::cout << offscreen->summary() << "\n" << allocationTracker.report() << std::endl;
+    }
+
+	// Uninterrupted single-player play, where a frame should not touch the heap
+    bool isSteadyFrame() const {
+        return currentState == GameState::PLAYING && !netplay;
+    }
+	// Close the allocation figures for this frame, reporting a failed check once
+    void endAllocationFrame(bool steady) {
+        bool wasFailed = allocationTracker.failed;
+        allocationTracker.endFrame(steady);
+        if (allocationTracker.failed && !wasFailed) std::cerr << allocationTracker.failure << std::endl;
+    }
+
+	// Event processing
+    void processEvents() {
+        while (const std::optional event = window.pollEvent()) handleEvent(*event);
+    }
+	// Handle one window event
+    void handleEvent(const sf::Event& event) {
+        if (event.is<sf::Event::Closed>()) window.close();
+		// Larger windows raise the native render scale; a recording keeps its size, so it ends
+        if (event.is<sf::Event::Resized>()) {
+            if (videoCapture.isRecording()) toggleVideoCapture(false);
+            resolutionScaler.resize(window.getSize());
+        }
+		// Frame pacing hotkeys: F2 cycles capped/vsync/uncapped, F3 shows stats
+        if (const auto* keyEvent = event.getIf<sf::Event::KeyPressed>()) {
+            AllocationTracker::Exempt oneOff;
+            if (keyEvent->code == sf::Keyboard::Key::F2) framePacer.cycleMode(window);
+            else if (keyEvent->code == sf::Keyboard::Key::F3) showFrameStats = !showFrameStats;
+            else if (keyEvent->code == sf::Keyboard::Key::F10) toggleVideoCapture(keyEvent->shift);
+        }
+
+		// Snapshots: F5 quick save, F9 quick load, R on game over retries from the boss checkpoint
+        if (const auto* keyEvent = event.getIf<sf::Event::KeyPressed>(); keyEvent && !netplay) {
+            AllocationTracker::Exempt oneOff;
+            if (currentState == GameState::PLAYING && keyEvent->code == sf::Keyboard::Key::F5) {
+                if (!quickSave) quickSave = std::make_unique<GameSnapshot>();
+                if (captureSnapshot(*quickSave) && saveSnapshot(*quickSave, SaveFiles::path("savegame.bin"))) hud.showPowerup("GAME SAVED");
+                else { quickSave.reset(); hud.showPowerup("SAVE FAILED"); }
+            }
+            else if (currentState == GameState::PLAYING && keyEvent->code == sf::Keyboard::Key::F9) {
+                if (!quickSave) {
+                    quickSave = std::make_unique<GameSnapshot>();
+                    if (!loadSnapshot(*quickSave, SaveFiles::path("savegame.bin"))) quickSave.reset();
+                }
+                if (quickSave) resumeFromSnapshot(*quickSave);
+            }
+            else if (currentState == GameState::GAME_OVER && keyEvent->code == sf::Keyboard::Key::R && checkpoint) {
+                resumeFromSnapshot(*checkpoint);
+                return;
+            }
+        }
+
+		// The top scene takes the event; a button press changes scene right away
+        switch (currentState) {
+        case GameState::MENU:
+            menu.handleInput(event, window);
+            prefetchForSelection(menu.selectedIconIndex);
+            if (menu.isStartPressed()) replaceScenes(GameState::PLAYING);
+            else if (menu.isOptionsPressed()) pushScene(GameState::OPTIONS);
+            else if (menu.isHighScorePressed()) pushScene(GameState::HIGHSCORE);
+            else if (menu.isExitPressed()) window.close();
+            break;
+        case GameState::OPTIONS:
+            optionsMenu.handleInput(event, window);
+            menuMusic.setVolume(optionsMenu.isMusicOn() ? 50.f : 0.f);
+            if (optionsMenu.isBackPressed()) popScene();
+            break;
+        case GameState::HIGHSCORE:
+            if (const auto* keyEvent = event.getIf<sf::Event::KeyPressed>(); keyEvent && keyEvent->code == sf::Keyboard::Key::Escape)
+                popScene();
+            break;
+        case GameState::PLAYING:
+            pauseMenu.handleInput(event, window);
+            if (pauseMenu.isPaused()) pushScene(GameState::PAUSED);
+            break;
+        case GameState::PAUSED:
+            pauseMenu.handleInput(event, window);
+            if (pauseMenu.getLastAction() == PauseMenu::TOGGLE_MUSIC) {
+                gameMusic.setVolume(pauseMenu.isMusicOn() ? 40.f : 0.f);
+                pauseMenu.resetAction();
+            }
+            else if (pauseMenu.getLastAction() == PauseMenu::EXIT_GAME) {
+                if (netplay) endNetplay();
+                resetGame();
+                replaceScenes(GameState::MENU);
+            }
+            else if (!pauseMenu.isPaused()) popScene();
+            break;
+        case GameState::GAME_OVER:
+            gameOverScreen.handleInput(event, window);
+            if (gameOverScreen.showMenu) prefetchForSelection(gameOverScreen.menu.selectedIconIndex);
+            if (gameOverScreen.isRetryPressed()) { resetGame(); replaceScenes(GameState::PLAYING); }
+            else if (gameOverScreen.isOptionsPressed()) pushScene(GameState::OPTIONS);
+            else if (gameOverScreen.isHighScorePressed()) pushScene(GameState::HIGHSCORE);
+            else if (gameOverScreen.isExitPressed()) window.close();
+            break;
+        default: break;
+        }
+    }
+
+	// Update function: per-frame work of the top scene only (transitions happen in handleEvent and the scene hooks)
+    void update(sf::Time dt) {
+        switch (currentState) {
+        case GameState::MENU: menu.update(dt); break;
+        case GameState::OPTIONS: optionsMenu.update(dt); break;
+        case GameState::PLAYING:
+            pauseMenu.update(dt);
+            if (netplay) updateNetplay(dt);
+            else {
+                playerInputs[0] = offscreen ? PlayerInput() : PlayerInput::fromKeyboard();
+                updatePlaying(dt);
+            }
+            break;
+        case GameState::PAUSED:
+            pauseMenu.update(dt);
+            // A co-op game keeps running under the pause menu
+            if (netplay) updateNetplay(dt);
+            break;
+        case GameState::GAME_OVER: {
+            bool menuShown = gameOverScreen.showMenu;
+            gameOverScreen.update(dt);
+            if (!menuShown && gameOverScreen.showMenu) prefetchForSelection(gameOverScreen.menu.selectedIconIndex);
+            break;
+        }
+        default: break;
+        }
+    }
+
+	// Spawn an explosion, merged with recent ones nearby and within the governor's effect cap
+    void spawnExplosion(AnimationLibrary::Id clip, float x, float y, ImpactEffects::Priority priority = ImpactEffects::KILL) {
+        impacts.add(explosions, spawnGovernor.maxExplosions(), animations, clip, x, y, priority, runTime);
+    }
+	// Screen shake, toned down and then shed under frame pressure; applied once at the end of the frame
+    void shakeScreen(float amount, float duration) {
+        float scale = spawnGovernor.shakeScale();
+        if (scale > 0.f) impacts.requestShake(amount * scale, duration);
+    }
+
+	// Player whose hitbox overlaps the bounds, if any
+    Player* playerHit(const sf::FloatRect& bounds) const {
+        if (bounds.findIntersection(player->getGlobalBounds())) return player;
+        if (player2 && bounds.findIntersection(player2->getGlobalBounds())) return player2;
+        return nullptr;
+    }
+	// Sounds are skipped while re-simulating frames that were already heard
+    void playSound(sf::Sound& sound) {
+        if (!resimulating && !offscreen && impacts.claimSound(sound)) sound.play();
+    }
+	// Index of a player in timer payloads, and back
+    int playerIndex(const Player& p) const { return &p == player2 ? 1 : 0; }
+    Player* playerAt(int index) const { return index == 0 ? player : index == 1 ? player2 : nullptr; }
+	// Player the boss aims at: the nearer one horizontally
+    const Player& bossTarget() const {
+        if (player2 && std::abs(player2->getPosition().x - activeBoss->getPosition().x) < std::abs(player->getPosition().x - activeBoss->getPosition().x))
+            return *player2;
+        return *player;
+    }
+	// Start (or restart) a timed powerup on a player
+    void grantTimedPowerup(Player& p, TimerWheel::Handle& effect, TimerWheel::Event end, float duration) {
+        timers.cancel(effect);
+        effect = timers.schedule(duration, end, playerIndex(p));
+    }
+	// Recurring timers every run starts with
+    void startRunTimers() {
+        timers.schedule(spawnTimerMax / (hud.getSpawnRateMultiplier() * spawnGovernor.spawnRateScale()), TimerWheel::ENEMY_SPAWN);
+        timers.schedule(swarmTimerMax / spawnGovernor.spawnRateScale(), TimerWheel::SWARM_WAVE);
+        timers.schedule(asteroidSpawnTimerMax / spawnGovernor.spawnRateScale(), TimerWheel::ASTEROID_SPAWN);
+        timers.schedule(1.f, TimerWheel::TELEMETRY_SAMPLE);
+    }
+	// Handle a timer that came due; recurring ones schedule their next firing at the current rate
+    void onTimer(const TimerWheel::Fired& t) {
+        switch (t.event) {
+        case TimerWheel::ENEMY_SPAWN:
+            if (activeBoss || enemies.size() >= spawnGovernor.maxEnemies()) { timers.schedule(spawnRetry, t.event); break; }
+            spawnEnemy();
+            timers.schedule(spawnTimerMax / (hud.getSpawnRateMultiplier() * spawnGovernor.spawnRateScale()), t.event);
+            break;
+        case TimerWheel::SWARM_WAVE:
+            if (activeBoss) { timers.schedule(spawnRetry, t.event); break; }
+            spawnSwarmWave();
+            timers.schedule(swarmTimerMax / spawnGovernor.spawnRateScale(), t.event);
+            break;
+        case TimerWheel::ASTEROID_SPAWN:
+            if (asteroids.size() >= spawnGovernor.maxAsteroids()) { timers.schedule(spawnRetry, t.event); break; }
+            asteroids.emplace_back(*asteroidTex, static_cast<float>(rng.nextInt(static_cast<int>(Playfield::width))), -50.f);
+            timers.schedule(asteroidSpawnTimerMax / spawnGovernor.spawnRateScale(), t.event);
+            break;
+        case TimerWheel::TELEMETRY_SAMPLE:
+			// Entity counts once a second
+            logEvent(Telemetry::SAMPLE, hud.getScore());
+            timers.schedule(1.f, t.event);
+            break;
+        case TimerWheel::BOSS_ATTACK:
+			// Volleys of a boss that has since been defeated are dropped
+            if (!activeBoss || t.a != bossCount) break;
+            activeBoss->attack(bossTarget().getPosition(), enemyBullets, *bulletTex);
+            timers.schedule(activeBoss->attackInterval(), t.event, bossCount);
+            break;
+        case TimerWheel::ATTACK_READY:
+            if (Player* p = playerAt(t.a)) p->attackReady = true;
+            break;
+        case TimerWheel::TRIPLE_SHOT_END:
+            if (Player* p = playerAt(t.a)) p->tripleShot = TimerWheel::Handle();
+            break;
+        case TimerWheel::HOMING_END:
+            if (Player* p = playerAt(t.a)) p->homing = TimerWheel::Handle();
+            break;
+        case TimerWheel::ENEMY_FIRE: {
+			// Indices shift as enemies die, so the timer names its enemy by id
+            auto it = std::find_if(enemies.begin(), enemies.end(), [&](const Enemy& e) { return e.id == t.a; });
+            if (it == enemies.end()) break;
+            Enemy& e = *it;
+            e.shot = TimerWheel::Handle();
+            if (e.behaviour < 0) {
+                enemyBullets.emplace_back(*bulletTex, e.getPosition().x, e.getPosition().y, BulletPatterns::straightDown);
+                e.shot = timers.schedule(e.shootCooldown, t.event, e.id);
+            }
+            else if (float next = BehaviourVM::autofire(e, behaviours, player->getPosition(), rng, enemyBullets, *bulletTex); next > 0.f)
+                e.shot = timers.schedule(next, t.event, e.id);
+            break;
+        }
+        default: break;
+        }
+    }
+	// One regular enemy at a random column
+    void spawnEnemy() {
+        float randX = static_cast<float>(rng.nextInt(static_cast<int>(Playfield::width) - 50));
+        int texIndex = rng.nextInt(static_cast<int>(enemyTextures.size()));
+        float cooldown = static_cast<float>(rng.nextInt(40) + 20) / 10.f;
+        Enemy& e = enemies.emplace_back(*enemyTextures[texIndex], randX, -50.f, cooldown);
+        e.id = nextEnemyId++;
+		// Every fourth spawn runs a scripted behaviour, which schedules its own fire
+        if (!behaviours.programs.empty() && rng.nextInt(4) == 0) {
+            int program = rng.nextInt(static_cast<int>(behaviours.programs.size()));
+            e.runBehaviour(program, behaviours.programs[program].hp);
+        }
+        else e.shot = timers.schedule(e.shootCooldown, TimerWheel::ENEMY_FIRE, e.id);
+    }
+	// Drop an enemy along with its pending shot
+    void removeEnemy(std::size_t k) {
+        timers.cancel(enemies[k].shot);
+        enemies.erase(enemies.begin() + k);
+    }
+	// Swarm waves fly in together, hold formation above the player, then dive row by row
+    void spawnSwarmWave() {
+        std::size_t room = spawnGovernor.maxDrones() - std::min(drones.count(), spawnGovernor.maxDrones());
+        int count = static_cast<int>(std::min<std::size_t>(swarmWaveSize, room));
+        int columns = std::max(1, std::min(swarmColumns, count));
+        for (int i = 0; i < count; i++) {
+            sf::Vector2f pos(Playfield::width * (i + 0.5f) / count, -50.f - (i % 3) * 12.f);
+            sf::Vector2f slot((i % columns - (columns - 1) / 2.f) * 30.f, -(i / columns) * 28.f);
+            drones.add(pos, slot, swarmHoldTime + (i / columns) * 0.6f);
+        }
+    }
+	// Fire a player's shots once the attack cooldown allows
+    void firePlayerShots(Player& shooter) {
+        if (!shooter.attackReady) return;
+        shooter.attackReady = false;
+        timers.schedule(shooter.attackCooldown, TimerWheel::ATTACK_READY, playerIndex(shooter));
+        playSound(shootSound);
+        float angleDeg = shooter.getRotation().asDegrees();
+        float angleRad = shooter.getRotation().asRadians();
+        float dirX = std::sin(angleRad), dirY = -std::cos(angleRad);
+        playerBullets.emplace_back(*playerBulletTex, shooter.getPosition().x - 12.5f, shooter.getPosition().y, dirX, dirY, angleDeg);
+        if (shooter.isTripleShotActive()) {
+            // Side shots: rotate the aim by a constant +/-15 degrees
+            const float c = BulletPatterns::tripleShotCos, s = BulletPatterns::tripleShotSin;
+            playerBullets.emplace_back(*playerBulletTex, shooter.getPosition().x - 15.f, shooter.getPosition().y,
+                dirX * c + dirY * s, dirY * c - dirX * s, angleDeg - 15.f);
+            playerBullets.emplace_back(*playerBulletTex, shooter.getPosition().x - 15.f, shooter.getPosition().y,
+                dirX * c - dirY * s, dirY * c + dirX * s, angleDeg + 15.f);
+        }
+        if (shooter.isHomingActive() && missiles.size() + 2 <= GameSnapshot::maxMissiles) {
+            // One missile out to each side at 45 degrees; they curve back in on their targets
+            const float d = 0.70710678f;
+            missiles.emplace_back(*playerBulletTex, shooter.getPosition().x, shooter.getPosition().y, (dirX - dirY) * d, (dirY + dirX) * d);
+            missiles.emplace_back(*playerBulletTex, shooter.getPosition().x, shooter.getPosition().y, (dirX + dirY) * d, (dirY - dirX) * d);
+        }
+    }
+
+	// Texture a powerup type is drawn with
+    const sf::Texture& powerupTexture(Powerup::Type type) const {
+        switch (type) {
+        case Powerup::SCORE_BONUS: case Powerup::SMART_BOMB: return *coinTex;
+        case Powerup::HEAL: return *healTex;
+        default: return *boltTex;
+        }
+    }
+	// Drop a random powerup; missiles and bombs are the rare ones
+    void dropPowerup(sf::Vector2f pos) {
+        int roll = rng.nextInt(10);
+        Powerup::Type type = roll < 3 ? Powerup::SCORE_BONUS : roll < 6 ? Powerup::HEAL : roll < 8 ? Powerup::TRIPLE_SHOT
+                           : roll < 9 ? Powerup::HOMING_MISSILES : Powerup::SMART_BOMB;
+        powerups.emplace_back(powerupTexture(type), type, pos.x, pos.y);
+    }
+	// Reward and remove a destroyed enemy
+    void killEnemy(std::size_t k) {
+        sf::Vector2f enemyPos = enemies[k].getPosition();
+        spawnExplosion(AnimationLibrary::EXPLOSION, enemyPos.x, enemyPos.y, ImpactEffects::KILL);
+        playSound(explosionSound);
+        hud.addScore(10); hud.addEnemyDefeated();
+        logEvent(Telemetry::ENEMY_KILLED, 10, enemyPos.x, enemyPos.y);
+		// 20% chance to drop powerup
+        if (rng.nextInt(2) == 0) dropPowerup(enemyPos);
+        removeEnemy(k);
+        shakeScreen(4.f, 0.2f);
+    }
+	// Reward the boss kill and schedule the next one
+    void defeatBoss() {
+        hud.addScore(100); hud.addEnemyDefeated();
+        logEvent(Telemetry::BOSS_DEFEATED, bossCount + 1, activeBoss->getPosition().x, activeBoss->getPosition().y);
+        spawnExplosion(AnimationLibrary::EXPLOSION, activeBoss->getPosition().x, activeBoss->getPosition().y, ImpactEffects::MAJOR);
+        shakeScreen(12.5f, 0.5f);
+        powerups.emplace_back(*healTex, Powerup::HEAL, activeBoss->getPosition().x, activeBoss->getPosition().y);
+        delete activeBoss; activeBoss = nullptr;
+        bossCount++;
+        nextBossScore += 600;
+    }
+	// Damage an indexed target; asteroids take a tenth, like bullets
+    void damageTarget(const SpatialIndex::Target& t, int damage) {
+        switch (t.kind) {
+        case SpatialIndex::ENEMY: enemies[t.index].takeDamage(damage); break;
+        case SpatialIndex::ASTEROID: asteroids[t.index].takeDamage(std::max(1, damage / 10)); break;
+        case SpatialIndex::BOSS: activeBoss->takeDamage(damage); break;
+        case SpatialIndex::DRONE: damageDrone(t.index, damage); break;
+        }
+    }
+	// Damage a drone, scoring it when this destroys it (destroyed drones are swept by removeDestroyedTargets)
+    void damageDrone(std::size_t i, int damage) {
+        if (drones.health[i] <= 0) return;
+        drones.health[i] -= damage;
+        if (drones.health[i] <= 0) hud.addScore(dronePoints);
+    }
+	// Collect enemies and the boss killed through the spatial index (asteroids pay out in their own loop)
+    void removeDestroyedTargets() {
+        for (std::size_t k = enemies.size(); k-- > 0;) if (enemies[k].getHp() <= 0) killEnemy(k);
+        if (activeBoss && !activeBoss->isAlive()) defeatBoss();
+        drones.compact([this](sf::Vector2f pos) {
+            spawnExplosion(AnimationLibrary::EXPLOSION, pos.x, pos.y, ImpactEffects::KILL);
+            playSound(explosionSound);
+        });
+    }
+	// Steer every missile, detonating on the first target it touches
+    void updateMissiles(sf::Time dt) {
+        spatialIndex.build(enemies, asteroids, activeBoss, drones);
+        for (std::size_t i = 0; i < missiles.size(); i++) {
+            Missile& m = missiles[i];
+		// Prefer whatever is dead ahead, so a missile does not veer off to a slightly closer target behind it
+            const SpatialIndex::Target* target = spatialIndex.raycast(m.getPosition(), m.direction, Missile::seekRange);
+            if (!target) target = spatialIndex.nearest(m.getPosition(), Missile::seekRange);
+            sf::Vector2f aim = target ? sf::Vector2f(target->x, target->y) : m.getPosition();
+            m.update(dt, target ? &aim : nullptr);
+            if (const SpatialIndex::Target* hit = spatialIndex.firstInRadius(m.getPosition(), Missile::hitRadius)) {
+                damageTarget(*hit, Missile::damage);
+                spawnExplosion(AnimationLibrary::EXPLOSION, m.getPosition().x, m.getPosition().y, ImpactEffects::HIT);
+                shakeScreen(2.f, 0.1f);
+                missiles.erase(missiles.begin() + i); i--;
+            }
+            else if (m.isExpired()) {
+                missiles.erase(missiles.begin() + i); i--;
+            }
+        }
+        removeDestroyedTargets();
+    }
+	// Heavy damage to everything around the collector
+    void detonateSmartBomb(sf::Vector2f center) {
+        spatialIndex.build(enemies, asteroids, activeBoss, drones);
+        spatialIndex.forEachInRadius(center, 350.f, [this](const SpatialIndex::Target& t) {
+            damageTarget(t, 70);
+            spawnExplosion(AnimationLibrary::EXPLOSION, t.x, t.y);
+        });
+        playSound(explosionSound);
+        shakeScreen(10.f, 0.4f);
+        removeDestroyedTargets();
+    }
+	// Solve the swarm's flow field while any drone is alive; returns whether it did
+    bool updateFlowField() {
+        if (drones.empty()) return false;
+        flowField.clear();
+		// A formation anchor above each player; drones hold their own slot around it
+        for (const Player* p : { player, player2 })
+            if (p) flowField.addGoal(p->getPosition() - sf::Vector2f(0.f, 260.f));
+		// Route around asteroids and the boss
+        for (const Asteroid& a : asteroids) {
+            if (!a.isAlive) continue;
+            sf::FloatRect bounds = a.getGlobalBounds();
+            flowField.addAvoidance(a.getPosition(), std::max(bounds.size.x, bounds.size.y) / 2.f + 40.f, 20.f);
+        }
+        if (activeBoss) {
+            sf::FloatRect bounds = activeBoss->getGlobalBounds();
+            flowField.addAvoidance(activeBoss->getPosition(), std::max(bounds.size.x, bounds.size.y) / 2.f + 40.f, 50.f);
+        }
+        flowField.solve();
+        return true;
+    }
+	// Steer the swarm, then resolve player bullets and rams through the spatial index
+    void updateDrones(sf::Time dt) {
+        if (!updateFlowField()) return;
+        drones.step(dt.asSeconds(), flowField, Playfield::width);
+        spatialIndex.build(enemies, asteroids, activeBoss, drones);
+        auto liveDrone = [this](const SpatialIndex::Target& t) { return t.kind == SpatialIndex::DRONE && drones.health[t.index] > 0; };
+        for (std::size_t i = 0; i < playerBullets.size(); i++) {
+            sf::FloatRect bounds = playerBullets[i].getGlobalBounds();
+            const SpatialIndex::Target* hit = spatialIndex.firstInRadius(bounds.position + bounds.size / 2.f, (bounds.size.x + bounds.size.y) / 4.f, liveDrone);
+            if (!hit) continue;
+            damageDrone(hit->index, 10);
+            playerBullets.erase(playerBullets.begin() + i); i--;
+        }
+		// A ram costs a heart and the drone, with no score
+        for (Player* p : { player, player2 }) {
+            if (!p) continue;
+            sf::FloatRect bounds = p->getGlobalBounds();
+            spatialIndex.forEachInRadius(bounds.position + bounds.size / 2.f, (bounds.size.x + bounds.size.y) / 4.f, [&](const SpatialIndex::Target& t) {
+                if (!liveDrone(t) || !hud.isAlive()) return;
+                drones.health[t.index] = 0;
+                hud.loseHeart();
+                logEvent(Telemetry::DAMAGE_TAKEN, hud.currentHearts, t.x, t.y);
+                shakeScreen(4.f, 0.2f);
+            });
+        }
+        removeDestroyedTargets();
+        if (!hud.isAlive()) endRun();
+    }
+
+	// Update playing state (deterministic given playerInputs, so co-op peers can replay it)
+    void updatePlaying(sf::Time dt) {
+        impacts.beginFrame();
+		// Update game objects
+        background->update(dt);
+        stars->update(dt);
+        player->update(dt, Playfield::size(), playerInputs[0], runTime);
+        if (player2) player2->update(dt, Playfield::size(), playerInputs[1], runTime);
+        hud.update(dt);
+        screenShake.update(dt);
+        runTime += dt.asSeconds();
+		// Timers that came due this frame (spawns, cooldowns, powerups running out)
+        for (const TimerWheel::Fired& t : timers.advance(dt.asSeconds())) onTimer(t);
+		// Death is likely, decode the game over screen ahead of time; drop it again if the player recovers
+        if ((hud.currentHearts <= 3) != gameOverPrefetched) {
+            AllocationTracker::Exempt oneOff;
+            gameOverPrefetched = !gameOverPrefetched;
+            if (gameOverPrefetched) resources.prefetchScene(GameState::GAME_OVER);
+            else resources.trim(GameState::PLAYING);
+        }
+
+        // Player shooting
+        firePlayerShots(*player);
+        if (player2) firePlayerShots(*player2);
+
+        // Update enemies in one batch; their shots come from ENEMY_FIRE timers
+        enemyKinematics.step(enemies, dt.asSeconds(), Playfield::width);
+        updateDrones(dt);
+        behaviourVM.step(enemies, behaviours, dt.asSeconds(), Playfield::width, player->getPosition(), rng, timers, enemyBullets, *bulletTex);
+        for (size_t i = 0; i < enemies.size(); i++) {
+            if (playerHit(enemies[i].getGlobalBounds())) {
+                for (int k = 0; k < 5 && hud.isAlive(); k++) hud.loseHeart();
+                logEvent(Telemetry::DAMAGE_TAKEN, hud.currentHearts, enemies[i].getPosition().x, enemies[i].getPosition().y);
+                playSound(explosionSound);
+                spawnExplosion(AnimationLibrary::EXPLOSION, enemies[i].getPosition().x, enemies[i].getPosition().y);
+                shakeScreen(4.f, 0.3f);
+                if (!hud.isAlive()) endRun();
+                removeEnemy(i); i--;
+            }
+            else if (!Playfield::contains(enemies[i].getGlobalBounds())) {
+                removeEnemy(i); i--;
+            }
+        }
+        if (!hud.isAlive()) endRun();
+
+        // Update Asteroids 
+        for (auto it = asteroids.begin(); it != asteroids.end();) {
+            it->update(dt);
+            if (playerHit(it->getGlobalBounds())) {
+                for (int k = 0; k < 5 && hud.isAlive(); k++) hud.loseHeart();
+                logEvent(Telemetry::DAMAGE_TAKEN, hud.currentHearts, it->getPosition().x, it->getPosition().y);
+                playSound(explosionSound);
+                shakeScreen(4.f, 0.2f);
+                if (!hud.isAlive()) endRun();
+                it = asteroids.erase(it); continue;
+            }
+			// Player bullets vs Asteroids
+            for (auto bulletIt = playerBullets.begin(); bulletIt != playerBullets.end();) {
+				// Bullet hits asteroid
+                if (it->getGlobalBounds().findIntersection(bulletIt->getGlobalBounds())) {
+                    it->takeDamage(1);
+                    spawnExplosion(AnimationLibrary::EXPLOSION, it->getPosition().x, it->getPosition().y, ImpactEffects::HIT);
+                    bulletIt = playerBullets.erase(bulletIt);
+                    shakeScreen(4.f, 0.15f);
+                }
+				// No hit, move to next bullet
+                else ++bulletIt;
+            }
+			// Remove asteroid if destroyed or out of bounds
+            if (!it->isAlive) {
+				playSound(explosionSound);
+                hud.addScore(30);
+                logEvent(Telemetry::ASTEROID_DESTROYED, 30, it->getPosition().x, it->getPosition().y);
+                spawnExplosion(AnimationLibrary::EXPLOSION, it->getPosition().x, it->getPosition().y);
+                it = asteroids.erase(it);
+            }
+			//  Out of bounds
+            else if (!Playfield::contains(it->getGlobalBounds())) it = asteroids.erase(it);
+			// Continue to next asteroid
+            else ++it;
+        }
+
+        
+		// Boss spawning (not once the run has ended this frame, or the checkpoint would hold a dead player)
+        if (hud.isAlive() && hud.getScore() >= nextBossScore && !activeBoss) {
+            AllocationTracker::Exempt oneOff;
+            int bossHealth = 250 + (bossCount * 100);
+            float bossBulletSpeed = 300.f + (std::min(bossCount, 5) * 30.f);
+            activeBoss = new Boss(*bossTex, bossHealth, bossBulletSpeed);
+            logEvent(Telemetry::BOSS_SPAWNED, bossHealth, activeBoss->getPosition().x, activeBoss->getPosition().y);
+            timers.schedule(activeBoss->attackInterval(), TimerWheel::BOSS_ATTACK, bossCount);
+			// Checkpoint for instant retry
+            if (!checkpoint) checkpoint = std::make_unique<GameSnapshot>();
+            if (!captureSnapshot(*checkpoint)) checkpoint.reset();
+        }
+		// Update Boss
+        if (activeBoss) {
+            activeBoss->update(dt, Playfield::size());
+            for (auto it = playerBullets.begin(); it != playerBullets.end();) {
+				// Player bullet hits boss
+                if (activeBoss->getGlobalBounds().findIntersection(it->getGlobalBounds())) {
+                    activeBoss->takeDamage(10);
+                    playSound(bossHitSound);
+                    spawnExplosion(AnimationLibrary::EXPLOSION, it->getPosition().x, it->getPosition().y, ImpactEffects::HIT);
+                    shakeScreen(4.f, 0.1f);
+                    it = playerBullets.erase(it);
+					// Check if boss defeated
+                    if (!activeBoss->isAlive()) { defeatBoss(); break; }
+                } else ++it;
+            }
+			// Boss vs Player
+            if (activeBoss && playerHit(activeBoss->getGlobalBounds())) {
+                hud.loseHeart(); shakeScreen(10.f, 0.2f);
+                logEvent(Telemetry::DAMAGE_TAKEN, hud.currentHearts, activeBoss->getPosition().x, activeBoss->getPosition().y);
+            }
+        }
+
+
+        // Homing missiles
+        updateMissiles(dt);
+
+        // Player bullets vs enemies
+        for (size_t i = 0; i < playerBullets.size(); i++) {
+            playerBullets[i].update(dt);
+            bool removed = false;
+            for (size_t k = 0; k < enemies.size(); k++) {
+				// Bullet hits enemy
+                if (playerBullets[i].getGlobalBounds().findIntersection(enemies[k].getGlobalBounds())) {
+                    sf::Vector2f enemyPos = enemies[k].getPosition();
+                    enemies[k].takeDamage(10);
+                    playerBullets.erase(playerBullets.begin() + i); removed = true;
+					// Check if enemy destroyed (the kill brings its own explosion)
+                    if (enemies[k].getHp() <= 0) killEnemy(k);
+					// Bullet processed, exit enemy loop
+                    else {
+                        spawnExplosion(AnimationLibrary::EXPLOSION, enemyPos.x, enemyPos.y, ImpactEffects::HIT);
+                        shakeScreen(4.f, 0.1f);
+                    }
+                    break;
+                }
+            }
+			// Remove bullet if out of bounds
+            if (!removed && playerBullets[i].isExpired()) {
+                playerBullets.erase(playerBullets.begin() + i); i--;
+            } else if (removed) i--;
+        }
+
+        // Enemy bullets vs player
+        for (size_t i = 0; i < enemyBullets.size(); i++) {
+            enemyBullets[i].update(dt);
+			// Bullet hits player
+            if (const Player* hit = playerHit(enemyBullets[i].getGlobalBounds())) {
+                sf::Vector2f playerPos = hit->getPosition();
+                enemyBullets.erase(enemyBullets.begin() + i);
+                hud.loseHeart();
+                logEvent(Telemetry::DAMAGE_TAKEN, hud.currentHearts, playerPos.x, playerPos.y);
+                spawnExplosion(AnimationLibrary::PLAYER_EXPLOSION, playerPos.x, playerPos.y, ImpactEffects::MAJOR);
+				// Check if player is dead
+                if (!hud.isAlive()) endRun();
+                shakeScreen(4.f, 0.10f);
+                i--;
+                continue;
+            }
+            // Remove bullet if out of bounds
+			else if (enemyBullets[i].isExpired()) {
+                enemyBullets.erase(enemyBullets.begin() + i); i--;
+            }
+        }
+
+        // Drop explosions whose clip has played out (frames are picked at render time)
+        explosions.erase(std::remove_if(explosions.begin(), explosions.end(),
+            [this](const Explosion& e) { return e.isFinished(animations, runTime); }), explosions.end());
+
+        // Powerups
+        for (size_t i = 0; i < powerups.size(); i++) {
+            powerups[i].update(dt);
+			// Check for collection by player
+            if (Player* collector = playerHit(powerups[i].getGlobalBounds())) {
+                logEvent(Telemetry::POWERUP_COLLECTED, powerups[i].getType(), powerups[i].sprite.getPosition().x, powerups[i].sprite.getPosition().y);
+                switch (powerups[i].getType()) {
+                case Powerup::SCORE_BONUS: hud.addScore(50); hud.showPowerup("+50 SCORE!"); break;
+                case Powerup::HEAL: hud.heal(3); hud.showPowerup("+3 HEALTH!"); break;
+                case Powerup::TRIPLE_SHOT: grantTimedPowerup(*collector, collector->tripleShot, TimerWheel::TRIPLE_SHOT_END, 10.f); hud.showPowerup("TRIPLE SHOT!");  break;
+                case Powerup::HOMING_MISSILES: grantTimedPowerup(*collector, collector->homing, TimerWheel::HOMING_END, 8.f); hud.showPowerup("HOMING MISSILES!"); break;
+                case Powerup::SMART_BOMB: detonateSmartBomb(collector->getPosition()); hud.showPowerup("SMART BOMB!"); break;
+                }
+                powerups.erase(powerups.begin() + i); i--;
+            }
+			// Remove if out of bounds
+            else if (!Playfield::contains(powerups[i].getGlobalBounds())) {
+                powerups.erase(powerups.begin() + i); i--;
+            }
+        }
+		// One shake for the frame, the strongest requested
+        if (impacts.shakeAmount > 0.f) screenShake.shake(impacts.shakeAmount, impacts.shakeDuration);
+        enforceSnapshotCaps();
+    }
+
+	// RENDER FUNCTION
+    void render() {
+        AllocationTracker::Scope tag(AllocationTracker::RENDER);
+        sf::RenderTarget& target = renderTarget();
+        renderClock.restart();
+        target.clear();
+		// game state menu
+        if (currentState == GameState::MENU) {
+            target.setView(sceneView());
+            menu.render(target);
+        }
+		// game state options
+        else if (currentState == GameState::OPTIONS) {
+            target.setView(sceneView());
+            optionsMenu.render(target);
+        }
+		// game state playing, with the pause menu over it when paused
+        else if (inRun()) {
+			// Apply screen shake to view
+            sf::View view = sceneView();
+            view.setCenter({ 600.f + screenShake.getOffset().x, 450.f + screenShake.getOffset().y });
+            target.setView(view);
+
+			// Render game objects
+            background->render(target);
+            stars->render(target);
+			// Entities outside the view are skipped
+            for (auto& b : playerBullets) if (Playfield::visible(b.getGlobalBounds())) b.render(target);
+            for (auto& b : enemyBullets) if (Playfield::visible(b.getGlobalBounds())) b.render(target);
+            for (auto& m : missiles) if (Playfield::visible(m.getGlobalBounds())) m.render(target);
+            for (auto& p : powerups) if (Playfield::visible(p.getGlobalBounds())) p.render(target);
+            for (auto& e : explosions) if (Playfield::visible(e.sprite.getGlobalBounds())) e.render(target, animations, runTime);
+            for (auto& a : asteroids) if (Playfield::visible(a.getGlobalBounds())) a.render(target);
+            const AnimationClip& bank = animations[AnimationLibrary::PLAYER_BANK];
+            player->render(target, bank, runTime);
+            if (player2) player2->render(target, bank, runTime);
+            if (activeBoss) activeBoss->render(target);
+            for (auto& e : enemies) if (Playfield::visible(e.getGlobalBounds())) e.render(target);
+            if (!enemyTextures.empty()) drones.render(target, *enemyTextures.front());
+            hud.render(target);
+            
+            pauseMenu.renderIcon(target);
+            if (currentState == GameState::PAUSED) pauseMenu.renderMenu(target);
+        }
+		// game state high score
+        else if (currentState == GameState::HIGHSCORE) {
+            target.setView(sceneView());
+            if (highScoreSprite) target.draw(*highScoreSprite);
+			// Draw high score text
+            sf::Text scoreNum(hud.getFont(), std::to_string(leaderboard.best()), 100);
+            scoreNum.setFillColor(sf::Color::White);
+            scoreNum.setOutlineColor(sf::Color::Black);
+            scoreNum.setOutlineThickness(4.f);
+            sf::FloatRect scoreBounds = scoreNum.getLocalBounds();
+            scoreNum.setOrigin({ scoreBounds.size.x / 2.f, scoreBounds.size.y / 2.f });
+            scoreNum.setPosition({ 600.f, 450.f });
+            target.draw(scoreNum);
+			// Top runs below the best score
+            const std::vector<RunRecord>& runs = leaderboard.getEntries();
+            for (std::size_t i = 1; i < runs.size(); i++) {
+                int seconds = static_cast<int>(runs[i].durationSeconds);
+                char line[96];
+                std::snprintf(line, sizeof(line), "%2d.  %6d   %3d kills   %d bosses   %d:%02d", static_cast<int>(i + 1),
+                    runs[i].score, runs[i].enemiesDefeated, runs[i].bosses, seconds / 60, seconds % 60);
+                sf::Text entry(hud.getFont(), line, 20);
+                entry.setFillColor(sf::Color(220, 220, 220));
+                sf::FloatRect entryBounds = entry.getLocalBounds();
+                entry.setOrigin({ entryBounds.size.x / 2.f, 0.f });
+                entry.setPosition({ 600.f, 540.f + static_cast<float>(i - 1) * 30.f });
+                target.draw(entry);
+            }
+            
+            sf::Text backText(hud.getFont(), "Press ESC", 30);
+            backText.setPosition({ 50.f, 850.f });
+            target.draw(backText);
+        }
+		// game state game over
+        else if (currentState == GameState::GAME_OVER) {
+            target.setView(sceneView());
+            background->render(target);
+            gameOverScreen.render(target);
+            hud.render(target);
+        }
+		// Frame pacing overlay (text refreshed twice a second)
+        if (showFrameStats && frameStatsText) {
+            AllocationTracker::Scope overlayTag(AllocationTracker::OVERLAY);
+            if (frameStatsClock.getElapsedTime().asSeconds() >= 0.5f) {
+                frameStatsClock.restart();
+                frameStatsText->setString(framePacer.summary() + "  |  " + spawnGovernor.summary() + "  |  " + impacts.summary()
+                    + "  |  " + resolutionScaler.summary() + "\n" + allocationTracker.summary()
+                    + (videoCapture.isRecording() ? "  |  " + videoCapture.summary() : ""));
+            }
+            target.setView(sceneView());
+            target.draw(*frameStatsText);
+        }
+		// Display the rendered frame (not counted as render cost, it may wait on vsync)
+        lastRenderTime = renderClock.getElapsedTime();
+        AllocationTracker::Scope presentTag(AllocationTracker::PRESENT);
+        if (offscreen) offscreen->capture(lastRenderTime);
+        else {
+            resolutionScaler.present(window);
+            videoCapture.captureFrame(window);
+            window.display();
+        }
+    }
 };
\ No newline at end of file
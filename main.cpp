@@ -1,7 +1,69 @@
-﻿#include "Game.h"
-
-int main() {
-    Game game;
-    game.run();
-    return 0;
+﻿#include "Game.h"
+#include <new>
+
+// Global allocation hooks: every heap allocation is counted by AllocationTracker
+void* operator new(std::size_t size) {
+    AllocationTracker::record(size);
+    if (void* memory = std::malloc(size ? size : 1)) return memory;
+    throw std::bad_alloc();
+}
+void* operator new[](std::size_t size) { return operator new(size); }
+void operator delete(void* memory) noexcept { std::free(memory); }
+void operator delete[](void* memory) noexcept { std::free(memory); }
+void operator delete(void* memory, std::size_t) noexcept { std::free(memory); }
+void operator delete[](void* memory, std::size_t) noexcept { std::free(memory); }
+
+int main(int argc, char* argv[]) {
+    // Command line options
+    int coopPlayer = 0;
+    unsigned short coopLocalPort = 0, coopRemotePort = 0;
+    std::string coopHost;
+    std::string offscreenDir;
+    int offscreenFrames = 0;
+    OffscreenRecorder::Format offscreenFormat = OffscreenRecorder::PNG;
+    bool allocationCheck = false;
+    for (int i = 1; i < argc; i++) {
+        std::string arg = argv[i];
+        if (arg == "--hires") ArtScale::highResolution = true;  // Keep full resolution art
+        // Print a telemetry log as text and exit: --decode-telemetry <file>
+        else if (arg == "--decode-telemetry" && i + 1 < argc) return Telemetry::decode(argv[i + 1], std::cout) ? 0 : 1;
+        // Co-op: --coop <1|2> <local port> <peer host> <peer port>
+        else if (arg == "--coop" && i + 4 < argc) {
+            coopPlayer = std::atoi(argv[i + 1]);
+            coopLocalPort = static_cast<unsigned short>(std::atoi(argv[i + 2]));
+            coopHost = argv[i + 3];
+            coopRemotePort = static_cast<unsigned short>(std::atoi(argv[i + 4]));
+            i += 4;
+        }
+        // Headless capture: --offscreen <dir> <frames> [png|raw]
+        else if (arg == "--offscreen" && i + 2 < argc) {
+            offscreenDir = argv[i + 1];
+            offscreenFrames = std::atoi(argv[i + 2]);
+            i += 2;
+            if (i + 1 < argc && std::string(argv[i + 1]) == "raw") { offscreenFormat = OffscreenRecorder::RAW; i++; }
+            else if (i + 1 < argc && std::string(argv[i + 1]) == "png") i++;
+        }
+        // Fail (exit code 2) if a steady-state PLAYING frame allocates
+        else if (arg == "--alloc-check") allocationCheck = true;
+    }
+    // Co-op instances on one machine keep their own save, leaderboard and telemetry files
+    if (coopPlayer == 1 || coopPlayer == 2) SaveFiles::suffix = "-" + std::to_string(coopLocalPort);
+    std::unique_ptr<OffscreenRecorder> recorder;
+    if (!offscreenDir.empty()) {
+        recorder = std::make_unique<OffscreenRecorder>();
+        if (!recorder->begin(offscreenDir, offscreenFrames, offscreenFormat)) {
+            std::cerr << "Offscreen: cannot create " << offscreenDir << " or a 1200x900 render texture" << std::endl;
+            return 1;
+        }
+    }
+    Game game(std::move(recorder));
+    game.allocationTracker.enforce = allocationCheck;
+    if (coopPlayer == 1 || coopPlayer == 2) {
+        if (!game.startNetplay(coopLocalPort, coopHost, coopRemotePort, coopPlayer - 1))
+            std::cerr << "Co-op: cannot bind port " << coopLocalPort << " or resolve " << coopHost << std::endl;
+    }
+    game.run();
+    if (allocationCheck && !game.offscreen) std::cout << game.allocationTracker.report() << std::endl;
+    if (game.offscreen && !game.offscreen->failedPath.empty()) return 1;
+    return game.allocationTracker.failed ? 2 : 0;
 }
\ No newline at end of file